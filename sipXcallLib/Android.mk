@@ -31,6 +31,7 @@ LOCAL_SRC_FILES := \
     src/cp/CSeqManager.cpp \
     src/cp/Connection.cpp \
     src/cp/CpCall.cpp \
+    src/cp/CpCallIdIndex.cpp \
     src/cp/CpCallManager.cpp \
     src/cp/CpGatewayManager.cpp \
     src/cp/CpGhostConnection.cpp \
@@ -63,6 +63,7 @@ class SipSession;
 class SipDialog;
 class SipLineMgr;
 class CpMediaInterfaceFactory;
+class OsServerTaskPool;
 
 //:Class short description which may consist of multiple lines (note the ':')
 // Class detailed description which may extend to multiple lines
@@ -287,6 +288,15 @@ public:
     virtual void setMaxCalls(int maxCalls);
     //:Set the maximum number of calls to admit to the system.
 
+    UtlBoolean setCallThreadPool(int numThreads);
+    //:Run the message handling of new calls on a pool of numThreads
+    //:worker threads instead of a thread per call.
+    //!param: numThreads - number of worker threads shared by the calls
+    //!returns: FALSE if a pool is already set or could not be started
+    // Must be set before any calls are created.  Calls in the pool are
+    // serialized exactly as with their own thread, but a call handler
+    // which blocks holds up a worker for all of the other calls.
+
     virtual void enableStun(const char* szStunServer, 
                             int iStunPort,
                             int iKeepAlivePeriodSecs,
@@ -469,8 +479,10 @@ private:
 
     CpMediaInterfaceFactory* mpMediaFactory;
     OsMsgDispatcher mDispatcher;
+    OsServerTaskPool* mpCallPool; // Worker threads for the calls, if set
 
     // Private accessors
+    void startCall(CpCall* call);
     void pushCall(CpCall* call);
     CpCall* popCall();
     CpCall* removeCall(CpCall* call);
@@ -0,0 +1,102 @@
+//
+// Copyright (C) 2006-2019 SIPez LLC.  All rights reserved.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CpCallIdIndex_h_
+#define _CpCallIdIndex_h_
+
+// SYSTEM INCLUDES
+
+// APPLICATION INCLUDES
+#include <os/OsMutex.h>
+#include <utl/UtlHashMap.h>
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+class CpCall;
+
+//! Index of the SIP Call-IDs that each call answers to
+/*! Maps a Call-ID to the calls which have, or have had, a connection
+ *  (or the call itself) with that Call-ID, so that the call manager can
+ *  dispatch a message without asking every call whether it will take it.
+ *
+ *  Call-IDs are added as calls and connections are given them and are
+ *  only dropped when the call is removed from the index.  The index
+ *  therefore returns a superset of the calls which currently have a
+ *  Call-ID and the caller must confirm a match with CpCall::hasCallId or
+ *  CpCall::willHandleMessage.  The number of Call-IDs a call goes through
+ *  in its lifetime is small (transfers and replaces) so the stale entries
+ *  cost little.
+ *
+ *  The index has its own lock which is never held while calling out, so
+ *  it may be updated with call, connection or call list locks held.
+ */
+class CpCallIdIndex
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+/* ============================ CREATORS ================================== */
+
+    //! Default constructor
+    CpCallIdIndex();
+
+    //! Destructor
+    virtual
+    ~CpCallIdIndex();
+
+/* ============================ MANIPULATORS ============================== */
+
+    //! Note that the call answers to the given Call-ID
+    /*! Adding a Call-ID the call already has is a no-op.
+     */
+    void addCallId(CpCall* call, const char* callId);
+
+    //! Remove all of the Call-IDs of the given call
+    void removeCall(CpCall* call);
+
+/* ============================ ACCESSORS ================================= */
+
+    //! Get the calls which may have the given Call-ID
+    /*! \param callId - Call-ID to look up
+     *  \param calls - array filled with the candidate calls
+     *  \param maxCalls - size of the calls array
+     *  \returns the number of calls put in the array
+     */
+    int getCalls(const char* callId, CpCall* calls[], int maxCalls);
+
+    //! Number of distinct Call-IDs in the index
+    int numCallIds();
+
+    //! Number of calls in the index
+    int numCalls();
+
+/* ============================ INQUIRY =================================== */
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+    //! Copy constructor NOT ALLOWED
+    CpCallIdIndex(const CpCallIdIndex& rCpCallIdIndex);
+
+    //! Assignment operator NOT ALLOWED
+    CpCallIdIndex& operator=(const CpCallIdIndex& rhs);
+
+    OsMutex mMutex;
+    UtlHashMap mCallsByCallId; // UtlString Call-ID -> UtlSList of UtlVoidPtr(CpCall*)
+    UtlHashMap mCallIdsByCall; // UtlVoidPtr(CpCall*) -> UtlSList of UtlString Call-ID
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+#endif  // _CpCallIdIndex_h_
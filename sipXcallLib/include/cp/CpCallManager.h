@@ -30,6 +30,7 @@
 #include "net/SipContactDb.h"
 #include "net/SipDialog.h"
 #include "cp/Connection.h"
+#include "cp/CpCallIdIndex.h"
 #include "tapi/sipXtapiInternal.h"
 
 // DEFINES
@@ -280,6 +281,13 @@ public:
     //! For internal use only
     int getNewMetaEventId();
 
+    //! For internal use only
+    /*! Note that the call answers to the given Call-ID.  Called by calls
+     *  and connections as they are given Call-IDs so that messages can
+     *  be dispatched to the call without asking every call.
+     */
+    void indexCallId(CpCall* call, const char* callId);
+
     //@}
 
     /** @name Call Operations
@@ -810,6 +818,8 @@ protected:
 
     OsMutex mManagerMutex;
     OsRWMutex mCallListMutex;
+    // Call-IDs of the calls, has its own lock
+    CpCallIdIndex mCallIdIndex;
     // Mutex to protect mCallNum.
     static OsMutex mCallNumMutex;
     UtlHashBag mCallIndices;
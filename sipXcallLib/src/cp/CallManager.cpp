@@ -42,6 +42,7 @@
 #include <os/OsEvent.h>
 #include <os/OsReadLock.h>
 #include <os/OsWriteLock.h>
+#include <os/OsServerTaskPool.h>
 #include <utl/UtlNameValueTokenizer.h>
 #include <cp/CpPeerCall.h>
 #include "tao/TaoMessage.h"
@@ -67,6 +68,9 @@
 #define MAXIMUM_CALLSTATE_LOG_SIZE 100000
 #define CALL_STATUS_FIELD "status"
 #define SEND_KEY '#'
+// Calls looked at per Call-ID when dispatching, more than one call with
+// the same Call-ID only happens transiently during transfer and replaces
+#define MAX_CALLS_PER_CALL_ID 16
 char CONVERT_TO_STR[17] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
 '*', '#', 'A', 'B', 'C', 'D', 'F'};
 /*      _________________________
@@ -118,6 +122,7 @@ CallManager::CallManager(UtlBoolean isRequredUserIdMatch,
 , mIsEarlyMediaFor180(TRUE)
 , mpMediaFactory(NULL)
 , mDispatcher(&mIncomingQ) // Dispatch to this CallManagers message queue
+, mpCallPool(NULL)
 {
     OsStackTraceLogger(FAC_CP, PRI_DEBUG, "CallManager");
 
@@ -290,6 +295,9 @@ CallManager::~CallManager()
 
     waitUntilShutDown();   
 
+    // The calls have all left the pool
+    delete mpCallPool;
+
     // do not delete the codecFactory it is not owned here
 
 }
@@ -485,7 +493,7 @@ UtlBoolean CallManager::handleMessage(OsMsg& eventMessage)
                     // If we created a new call
                     if(handlingCall)
                     {
-                        handlingCall->start();
+                        startCall(handlingCall);
                         pushCall(handlingCall);
                         newCallCreated = TRUE;
                     }
@@ -539,6 +547,7 @@ UtlBoolean CallManager::handleMessage(OsMsg& eventMessage)
 
                 mCallListMutex.acquireWrite() ;                                                
                 releaseCallIndex(call->getCallIndex());
+                mCallIdIndex.removeCall(call);
                 if(infocusCall == call)
                 {
                     // The infocus call is not in the mCallList -- no need to 
@@ -3244,6 +3253,28 @@ void CallManager::setMaxCalls(int maxCalls)
     mMaxCalls = maxCalls;
 }
 
+// Run the message handling of new calls on a pool of worker threads.
+UtlBoolean CallManager::setCallThreadPool(int numThreads)
+{
+    UtlBoolean started = FALSE;
+
+    if(mpCallPool == NULL && numThreads > 0)
+    {
+        OsServerTaskPool* pool = new OsServerTaskPool("CallPool", numThreads);
+        if(pool->start())
+        {
+            mpCallPool = pool;
+            started = TRUE;
+        }
+        else
+        {
+            delete pool;
+        }
+    }
+
+    return(started);
+}
+
 // Enable STUN for NAT/Firewall traversal
 void CallManager::enableStun(const char* szStunServer, 
                              int iServerPort,
@@ -3451,6 +3482,18 @@ UtlBoolean CallManager::changeCallFocus(CpCall* callToTakeFocus)
     return(focusChanged);
 }
 
+void CallManager::startCall(CpCall* call)
+{
+    if(mpCallPool)
+    {
+        call->startInPool(*mpCallPool);
+    }
+    else
+    {
+        call->start();
+    }
+}
+
 void CallManager::pushCall(CpCall* call)
 {
     callStack.insertAt(0, new UtlVoidPtr((void*)call));
@@ -3516,21 +3559,20 @@ CpCall* CallManager::findHandlingCall(const char* callId)
 
     if(!handlingCall)
     {
-        UtlSListIterator iterator(callStack);
-        UtlVoidPtr* callCollectable;
-        CpCall* call;
-        callCollectable = (UtlVoidPtr*)iterator();
-        while(callCollectable &&
-            !handlingCall)
+        // Only the calls which have had the Call-ID need to be asked
+        CpCall* candidates[MAX_CALLS_PER_CALL_ID];
+        int numCandidates =
+            mCallIdIndex.getCalls(callId, candidates, MAX_CALLS_PER_CALL_ID);
+        for(int candidateIndex = 0;
+            candidateIndex < numCandidates && !handlingCall;
+            candidateIndex++)
         {
-            call = (CpCall*)callCollectable->getValue();
-            if(call && call->hasCallId(callId))
+            CpCall* call = candidates[candidateIndex];
+            if(call != infocusCall && call->hasCallId(callId))
             {
                 handlingCall = call;
             }
-            callCollectable = (UtlVoidPtr*)iterator();
         }
-
     }
 
     return(handlingCall);
@@ -3586,7 +3628,63 @@ CpCall* CallManager::findHandlingCall(const OsMsg& eventMessage)
         }
     }
 
-    if(handlingWeight != CpCall::CP_DEFINITELY_WILL_HANDLE)
+    const SipMessage* sipMsg = NULL;
+    if(eventMessage.getMsgType() == OsMsg::PHONE_APP &&
+       eventMessage.getMsgSubType() == CP_SIP_MESSAGE)
+    {
+        sipMsg = ((SipMessageEvent&)eventMessage).getMessage();
+    }
+
+    if(handlingWeight != CpCall::CP_DEFINITELY_WILL_HANDLE && sipMsg)
+    {
+        // A call only takes a SIP message with one of its Call-IDs, or an
+        // INVITE which replaces one of its Call-IDs.  So only the calls
+        // which have had those Call-IDs need to be asked.
+        CpCall* candidates[2 * MAX_CALLS_PER_CALL_ID];
+        UtlString callId;
+        sipMsg->getCallIdField(&callId);
+        int numCandidates =
+            mCallIdIndex.getCalls(callId, candidates, MAX_CALLS_PER_CALL_ID);
+
+        UtlString method;
+        if(!sipMsg->isResponse())
+        {
+            sipMsg->getRequestMethod(&method);
+        }
+        if(method.compareTo(SIP_INVITE_METHOD) == 0)
+        {
+            UtlString toTag;
+            UtlString fromTag;
+            if(sipMsg->getReplacesData(callId, toTag, fromTag))
+            {
+                numCandidates +=
+                    mCallIdIndex.getCalls(callId, &candidates[numCandidates],
+                                          MAX_CALLS_PER_CALL_ID);
+            }
+        }
+
+        for(int candidateIndex = 0; candidateIndex < numCandidates; candidateIndex++)
+        {
+            CpCall* call = candidates[candidateIndex];
+            if(call != infocusCall)
+            {
+                thisCallHandlingWeight =
+                    call->willHandleMessage(eventMessage);
+
+                if(thisCallHandlingWeight > handlingWeight)
+                {
+                    handlingWeight = thisCallHandlingWeight;
+                    handlingCall = call;
+                }
+
+                if(handlingWeight == CpCall::CP_DEFINITELY_WILL_HANDLE)
+                {
+                    break;
+                }
+            }
+        }
+    }
+    else if(handlingWeight != CpCall::CP_DEFINITELY_WILL_HANDLE)
     {
         UtlSListIterator iterator(callStack);
         UtlVoidPtr* callCollectable;
@@ -4096,7 +4194,7 @@ OsStatus CallManager::doCreateCall(const char* callId,
             // Short term kludge: createCall invoked, this
             // implys the phone is off hook
             call->enableDtmf();
-            call->start();
+            startCall(call);
 
             if(metaEventId > 0)
             {
@@ -4298,6 +4396,7 @@ void CallManager::onCallDestroy(CpCall* call)
 
         mCallListMutex.acquireWrite() ;                                                
         releaseCallIndex(call->getCallIndex());
+        mCallIdIndex.removeCall(call);
         if(infocusCall == call)
         {
             // The infocus call is not in the mCallList -- no need to 
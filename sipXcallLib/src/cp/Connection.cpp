@@ -561,6 +561,11 @@ void Connection::setCallId(const char* callId)
     if(mpCall)
     {
         mpCall->getCallId(callCallId);
+
+        if(mpCallManager)
+        {
+            mpCallManager->indexCallId(mpCall, callId);
+        }
     }
     OsSysLog::add(FAC_CP, PRI_DEBUG,
             "Connection::setCallId(%s) Call callId: %s for call thread: %s",
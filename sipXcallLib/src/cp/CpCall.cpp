@@ -122,7 +122,7 @@ CpCall::CpCall(CpCallManager* manager,
 // Destructor
 CpCall::~CpCall()
 {
-    if (isStarted())
+    if (isStarted() || getPool())
     {
         waitUntilShutDown();
     }
@@ -643,9 +643,16 @@ void CpCall::getCallId(UtlString& callId)
 
 void CpCall::setCallId(const char* callId)
 {
-    OsWriteLock lock(mCallIdMutex);
-    mCallId.remove(0);
-    if(callId) mCallId.append(callId);
+    {
+        OsWriteLock lock(mCallIdMutex);
+        mCallId.remove(0);
+        if(callId) mCallId.append(callId);
+    }
+
+    if(mpManager)
+    {
+        mpManager->indexCallId(this, callId);
+    }
 }
 
 void CpCall::enableDtmf()
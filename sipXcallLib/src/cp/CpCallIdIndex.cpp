@@ -0,0 +1,162 @@
+//
+// Copyright (C) 2006-2019 SIPez LLC.  All rights reserved.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+
+// APPLICATION INCLUDES
+#include <cp/CpCallIdIndex.h>
+#include <os/OsLock.h>
+#include <utl/UtlHashMapIterator.h>
+#include <utl/UtlSList.h>
+#include <utl/UtlSListIterator.h>
+#include <utl/UtlString.h>
+#include <utl/UtlVoidPtr.h>
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+// Constructor
+CpCallIdIndex::CpCallIdIndex()
+    : mMutex(OsMutex::Q_FIFO)
+{
+}
+
+// Destructor
+CpCallIdIndex::~CpCallIdIndex()
+{
+    OsLock lock(mMutex);
+
+    // Values are lists which own their elements
+    UtlHashMapIterator callIdIterator(mCallsByCallId);
+    while(callIdIterator())
+    {
+        ((UtlSList*) callIdIterator.value())->destroyAll();
+    }
+    mCallsByCallId.destroyAll();
+
+    UtlHashMapIterator callIterator(mCallIdsByCall);
+    while(callIterator())
+    {
+        ((UtlSList*) callIterator.value())->destroyAll();
+    }
+    mCallIdsByCall.destroyAll();
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+void CpCallIdIndex::addCallId(CpCall* call, const char* callId)
+{
+    if(call && callId && *callId)
+    {
+        OsLock lock(mMutex);
+
+        UtlVoidPtr callKey(call);
+        UtlSList* callIds = (UtlSList*) mCallIdsByCall.findValue(&callKey);
+        if(callIds == NULL)
+        {
+            callIds = new UtlSList();
+            mCallIdsByCall.insertKeyAndValue(new UtlVoidPtr(call), callIds);
+        }
+
+        UtlString callIdKey(callId);
+        if(callIds->find(&callIdKey) == NULL)
+        {
+            callIds->append(new UtlString(callIdKey));
+
+            UtlSList* calls = (UtlSList*) mCallsByCallId.findValue(&callIdKey);
+            if(calls == NULL)
+            {
+                calls = new UtlSList();
+                mCallsByCallId.insertKeyAndValue(new UtlString(callIdKey), calls);
+            }
+            calls->append(new UtlVoidPtr(call));
+        }
+    }
+}
+
+void CpCallIdIndex::removeCall(CpCall* call)
+{
+    OsLock lock(mMutex);
+
+    UtlVoidPtr callKey(call);
+    UtlContainable* value = NULL;
+    UtlContainable* key = mCallIdsByCall.removeKeyAndValue(&callKey, value);
+    UtlSList* callIds = (UtlSList*) value;
+    if(callIds)
+    {
+        UtlString* callId;
+        while((callId = (UtlString*) callIds->get()))
+        {
+            UtlSList* calls = (UtlSList*) mCallsByCallId.findValue(callId);
+            if(calls)
+            {
+                delete calls->remove(&callKey);
+                if(calls->isEmpty())
+                {
+                    UtlContainable* emptyCalls = NULL;
+                    delete mCallsByCallId.removeKeyAndValue(callId, emptyCalls);
+                    delete emptyCalls;
+                }
+            }
+            delete callId;
+        }
+        delete callIds;
+    }
+    delete key;
+}
+
+/* ============================ ACCESSORS ================================= */
+
+int CpCallIdIndex::getCalls(const char* callId, CpCall* calls[], int maxCalls)
+{
+    int numFound = 0;
+
+    if(callId && *callId)
+    {
+        OsLock lock(mMutex);
+
+        UtlString callIdKey(callId);
+        UtlSList* callList = (UtlSList*) mCallsByCallId.findValue(&callIdKey);
+        if(callList)
+        {
+            UtlSListIterator iterator(*callList);
+            UtlVoidPtr* callPtr;
+            while(numFound < maxCalls &&
+                  (callPtr = (UtlVoidPtr*) iterator()))
+            {
+                calls[numFound++] = (CpCall*) callPtr->getValue();
+            }
+        }
+    }
+
+    return(numFound);
+}
+
+int CpCallIdIndex::numCallIds()
+{
+    OsLock lock(mMutex);
+    return(mCallsByCallId.entries());
+}
+
+int CpCallIdIndex::numCalls()
+{
+    OsLock lock(mMutex);
+    return(mCallIdsByCall.entries());
+}
+
+/* ============================ INQUIRY =================================== */
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
@@ -381,6 +381,11 @@ void CpCallManager::getNewCallId(UtlString* callId)
     getNewCallId(mCallIdPrefix, callId);
 }
 
+void CpCallManager::indexCallId(CpCall* call, const char* callId)
+{
+    mCallIdIndex.addCallId(call, callId);
+}
+
 void CpCallManager::getNewSessionId(UtlString* callId)
 {
     getNewCallId("s", callId);
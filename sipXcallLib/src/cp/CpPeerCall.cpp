@@ -4931,6 +4931,14 @@ Connection* CpPeerCall::findHandlingConnection(UtlString& remoteAddress)
 void CpPeerCall::addConnection(Connection* connection)
 {
     connection->setLocalAddress(mLocalAddress.data());
+
+    // The connection may have been given its Call-ID before it was added
+    if(mpManager)
+    {
+        UtlString connectionCallId;
+        connection->getCallId(&connectionCallId);
+        mpManager->indexCallId(this, connectionCallId);
+    }
     
 	OsWriteLock lock(mConnectionMutex);
     mConnections.append(connection);
@@ -0,0 +1,174 @@
+//
+// Copyright (C) 2006-2019 SIPez LLC.  All rights reserved.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <stdio.h>
+
+// APPLICATION INCLUDES
+#include "os/OsDateTime.h"
+#include "utl/UtlSList.h"
+#include "utl/UtlSListIterator.h"
+#include "utl/UtlString.h"
+#include "cp/CpCallIdIndex.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+int externalForSideEffects;
+
+// CONSTANTS
+#define NUM_SETUPS 20000
+// Messages for the calls already up dispatched for each call set up
+#define MESSAGES_PER_CALL 6
+#define MAX_ACTIVE_CALLS 10000
+
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+
+// Stand in for the calls, the index never dereferences them
+char callPlaceholders[MAX_ACTIVE_CALLS + NUM_SETUPS];
+
+CpCall* callAt(int index)
+{
+   return((CpCall*) &callPlaceholders[index]);
+}
+
+void makeCallId(int index, UtlString& callId)
+{
+   char buffer[64];
+   sprintf(buffer, "%08x-%d@10.1.1.2", index * 2654435761u, index);
+   callId = buffer;
+}
+
+// Report the rate of call setups
+void printRate(int activeCalls, const char* method, int setups,
+               OsTime start, OsTime end)
+{
+   double seconds = (end - start).getDouble();
+
+   printf("  %6d active calls, %-12s %10.0f setups per second\n",
+          activeCalls, method, seconds > 0 ? setups / seconds : 0.0);
+}
+
+// Asking each call in turn, as CallManager::findHandlingCall did
+UtlString* scanCalls(UtlSList& calls, const UtlString& callId)
+{
+   UtlSListIterator iterator(calls);
+   UtlString* call;
+   while((call = (UtlString*) iterator()))
+   {
+      if(call->compareTo(callId) == 0)
+      {
+         break;
+      }
+   }
+   return(call);
+}
+
+// Measures the Call-ID lookups done by the call manager for each new call
+// while a given number of other calls are up: the initial INVITE which
+// matches no call, the call and its connection taking the Call-ID,
+// messages for the calls already up, and the call going away.
+int main()
+{
+   static const int activeCallCounts[] = { 10, 100, 1000, MAX_ACTIVE_CALLS };
+   CpCall* candidates[16];
+   int setup;
+   int message;
+
+   printf("Call-ID dispatch, call setups of %d messages each:\n",
+          MESSAGES_PER_CALL + 1);
+
+   for (unsigned int count = 0;
+        count < sizeof(activeCallCounts) / sizeof(activeCallCounts[0]);
+        count++)
+   {
+      int activeCalls = activeCallCounts[count];
+      CpCallIdIndex index;
+      UtlSList callList;
+      UtlString callId;
+      UtlString activeCallId;
+      int callNum;
+      int expected = 0;
+      externalForSideEffects = 0;
+
+      for (callNum = 0; callNum < activeCalls; callNum++)
+      {
+         makeCallId(callNum, callId);
+         index.addCallId(callAt(callNum), callId);
+         callList.insertAt(0, new UtlString(callId));
+      }
+
+      OsTime indexStart;
+      OsTime indexEnd;
+      OsDateTime::getCurTime(indexStart);
+      for (setup = 0; setup < NUM_SETUPS; setup++)
+      {
+         CpCall* call = callAt(activeCalls + setup);
+         makeCallId(activeCalls + setup, callId);
+
+         externalForSideEffects += index.getCalls(callId, candidates, 16);
+         index.addCallId(call, callId);
+         index.addCallId(call, callId);
+         for (message = 0; message < MESSAGES_PER_CALL; message++)
+         {
+            makeCallId((setup * 7919 + message * 104729) % activeCalls,
+                       activeCallId);
+            externalForSideEffects +=
+               index.getCalls(activeCallId, candidates, 16);
+         }
+         index.removeCall(call);
+      }
+      OsDateTime::getCurTime(indexEnd);
+      expected += NUM_SETUPS * MESSAGES_PER_CALL;
+
+      // The scan is so slow with many calls that fewer setups will do
+      int scanSetups = NUM_SETUPS;
+      if (activeCalls > 100)
+      {
+         scanSetups = NUM_SETUPS * 100 / activeCalls;
+      }
+
+      OsTime scanStart;
+      OsTime scanEnd;
+      OsDateTime::getCurTime(scanStart);
+      for (setup = 0; setup < scanSetups; setup++)
+      {
+         makeCallId(activeCalls + setup, callId);
+
+         externalForSideEffects += scanCalls(callList, callId) != NULL;
+         UtlString* newCall = new UtlString(callId);
+         callList.insertAt(0, newCall);
+         for (message = 0; message < MESSAGES_PER_CALL; message++)
+         {
+            makeCallId((setup * 7919 + message * 104729) % activeCalls,
+                       activeCallId);
+            externalForSideEffects +=
+               scanCalls(callList, activeCallId) != NULL;
+         }
+         callList.removeReference(newCall);
+         delete newCall;
+      }
+      OsDateTime::getCurTime(scanEnd);
+      expected += scanSetups * MESSAGES_PER_CALL;
+
+      callList.destroyAll();
+
+      if (externalForSideEffects != expected ||
+          index.numCalls() != activeCalls)
+      {
+         printf("Call-ID lookups failed\n");
+         return 1;
+      }
+
+      printRate(activeCalls, "index", NUM_SETUPS, indexStart, indexEnd);
+      printRate(activeCalls, "linear scan", scanSetups, scanStart, scanEnd);
+   }
+
+   return 0;
+}
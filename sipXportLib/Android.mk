@@ -120,6 +120,7 @@ LOCAL_SRC_FILES := \
     src/os/OsRpcMsg.cpp \
     src/os/OsServerSocket.cpp \
     src/os/OsServerTask.cpp \
+    src/os/OsServerTaskPool.cpp \
     src/os/OsSharedLibMgr.cpp \
     src/os/OsSocket.cpp \
     src/os/OsSocketCrypto.cpp \
@@ -311,6 +312,7 @@ LOCAL_SRC_FILES := \
   src/test/os/OsProcessTest.cpp \
   src/test/os/OsSemTest.cpp \
   src/test/os/OsServerTaskTest.cpp \
+  src/test/os/OsServerTaskPoolTest.cpp \
   src/test/os/OsSharedLibMgrTest.cpp \
   src/test/os/OsSocketTest.cpp \
   src/test/os/OsTestUtilities.cpp \
@@ -408,6 +410,7 @@ LOCAL_SRC_FILES := \
   src/test/os/OsProcessTest.cpp \
   src/test/os/OsSemTest.cpp \
   src/test/os/OsServerTaskTest.cpp \
+  src/test/os/OsServerTaskPoolTest.cpp \
   src/test/os/OsSharedLibMgrTest.cpp \
   src/test/os/OsSocketTest.cpp \
   src/test/os/OsTestUtilities.cpp \
@@ -32,6 +32,7 @@ class OsMsg;
 // TYPEDEFS
 typedef UtlBoolean (*OsMsgQSendHookPtr) (const OsMsg& rMsg);
 typedef void      (*OsMsgQFlushHookPtr) (const OsMsg& rMsg);
+typedef void      (*OsMsgQQueuedHookPtr) (void* pHookData);
 
 //:Message queue for inter-task communication
 
@@ -129,6 +130,15 @@ public:
      *  inserted into the queue.
      */
 
+     /// Set the function that is invoked after a msg has been put in the queue
+   virtual void setQueuedHook(OsMsgQQueuedHookPtr func, void* pHookData);
+     /**<
+     *  Lets a queue which is not read by a task of its own tell whoever
+     *  services it that there is work to do.  The function is called
+     *  without the queue lock held and gets pHookData as its argument.
+     *  Pass NULL to remove the hook.
+     */
+
      /// Set the function that is invoked whenever a msg is flushed from the queue.
    virtual void setFlushHook(OsMsgQFlushHookPtr func);
      /**<
@@ -166,6 +176,10 @@ protected:
      /// Method that is invoked whenever a message is flushed from the queue
    OsMsgQFlushHookPtr mFlushHookFunc;
 
+     /// Method that is invoked after a message has been put in the queue
+   OsMsgQQueuedHookPtr mQueuedHookFunc;
+   void* mpQueuedHookData;
+
 /* ---------------------------- DEBUG SCAFFOLDING ------------------------- */
 protected:
 
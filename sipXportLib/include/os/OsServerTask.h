@@ -28,6 +28,7 @@
 
 // FORWARD DECLARATIONS
 class OsMsg;
+class OsServerTaskPool;
 
 //:Abstract base class for tasks that process incoming msgs from an OsMsgQ
 
@@ -83,17 +84,36 @@ public:
      //:Call OsTask::requestShutdown() and then post an OS_SHUTDOWN message 
      //:to the incoming message queue to unblock the task
 
+   UtlBoolean startInPool(OsServerTaskPool& rPool);
+     //:Run this task on the worker threads of a pool instead of start()
+     // The task gets no thread of its own, see OsServerTaskPool.  The task
+     // stays in the pool until waitUntilShutDown() is called, which the
+     // destructor does.
+
+   int handleQueuedMessages(int maxMessages);
+     //:Handle up to maxMessages queued messages without waiting
+     // Used by OsServerTaskPool to run the task.  Returns the number of
+     // messages taken from the queue.
+
+   virtual UtlBoolean waitUntilShutDown(int milliSecToWait = 20000);
+     //:Take the task out of its pool, if it has one, and wait for it
+     //:to shut down
+
 /* ============================ ACCESSORS ================================= */
 
    OsMsgQ* getMessageQueue();
      //:Get the pointer to the incoming message queue
 
+   OsServerTaskPool* getPool() const;
+     //:Get the pool the task runs in, NULL if it has its own thread
+
 /* ============================ INQUIRY =================================== */
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
 
    OsMsgQ mIncomingQ;                 // Queue for incoming messages.
+   OsServerTaskPool* mpPool;          // Pool running the task, if any.
 
    virtual OsStatus receiveMessage(OsMsg*& rpMsg);
      //:Waits for a message to arrive on the task's incoming message queue
@@ -112,6 +132,9 @@ protected:
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
 
+   static void queuedHook(void* pTask);
+     //:Schedule a pooled task when a message is put in its queue
+
    OsServerTask(const OsServerTask& rOsServerTask);
      //:Copy constructor (not implemented for this class)
 
@@ -0,0 +1,135 @@
+//
+// Copyright (C) 2006-2019 SIPez LLC.  All rights reserved.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _OsServerTaskPool_h_
+#define _OsServerTaskPool_h_
+
+// SYSTEM INCLUDES
+
+// APPLICATION INCLUDES
+#include "os/OsDefs.h"
+#include "os/OsCSem.h"
+#include "os/OsMutex.h"
+#include "os/OsTask.h"
+#include "utl/UtlHashBag.h"
+#include "utl/UtlSList.h"
+#include "utl/UtlString.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+class OsServerTask;
+class OsServerTaskPoolWorker;
+
+/// Fixed set of threads which run the message loops of many OsServerTasks
+/**
+*  A task started with OsServerTask::startInPool() gets no thread of its
+*  own.  When a message is put in its queue the task is put on the run
+*  queue of the pool and the next free worker thread handles the task's
+*  messages.  A task is only ever run by one worker at a time so its
+*  handleMessage() is serialized exactly as if it had its own thread.
+*  To keep the tasks fair a worker handles at most maxMessagesPerTurn
+*  messages before putting the task back on the end of the run queue.
+*
+*  As the workers are shared, a handler which blocks holds up other
+*  tasks: a blocking send to a full queue, or waiting for another task
+*  of the same pool, can stall the pool if every worker does it at once.
+*/
+class OsServerTaskPool
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+   enum
+   {
+      DEF_MAX_MESSAGES_PER_TURN = 16
+   };
+
+/* ============================ CREATORS ================================== */
+
+     /// Constructor, the worker threads are not started until start()
+   OsServerTaskPool(const UtlString& name,
+                    int numWorkers,
+                    int maxMessagesPerTurn = DEF_MAX_MESSAGES_PER_TURN,
+                    const int priority = OsTaskBase::DEF_PRIO,
+                    const int stackSize = OsTaskBase::DEF_STACKSIZE);
+
+     /// Destructor, stops the worker threads
+   virtual
+   ~OsServerTaskPool();
+     /**<
+     *  All tasks should have been shut down before the pool is destroyed.
+     */
+
+/* ============================ MANIPULATORS ============================== */
+
+     /// Start the worker threads
+   UtlBoolean start();
+
+     /// Add a task to the pool, see OsServerTask::startInPool()
+   void addTask(OsServerTask* pTask);
+
+     /// Remove a task from the pool, waiting if a worker is running it
+   void removeTask(OsServerTask* pTask);
+     /**<
+     *  After this returns no worker will touch the task again.
+     */
+
+     /// Put a task with queued messages on the run queue
+   void scheduleTask(OsServerTask* pTask);
+
+/* ============================ ACCESSORS ================================= */
+
+     /// Number of worker threads
+   int getNumWorkers() const;
+
+     /// Number of tasks in the pool
+   int getNumTasks();
+
+     /// Number of messages handled by the workers so far
+   int getNumMessagesHandled();
+
+/* ============================ INQUIRY =================================== */
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+   friend class OsServerTaskPoolWorker;
+
+     /// Run the next task on the run queue, called by the worker threads
+   UtlBoolean runNextTask(OsServerTaskPoolWorker* pWorker);
+     /**<
+     *  @returns FALSE once the pool is being destroyed.
+     */
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+   OsServerTaskPool(const OsServerTaskPool& rOsServerTaskPool);
+     //:Copy constructor (not implemented for this class)
+
+   OsServerTaskPool& operator=(const OsServerTaskPool& rhs);
+     //:Assignment operator (not implemented for this class)
+
+   UtlString mName;
+   int mMaxMessagesPerTurn;
+   int mNumWorkers;
+   OsServerTaskPoolWorker** mpWorkers;
+   OsMutex mMutex;           ///< Guards the task states and the run queue
+   OsCSem mRunnable;         ///< Count of entries on the run queue
+   UtlHashBag mTaskStates;   ///< Scheduling state of each task, keyed by task
+   UtlSList mRunQueue;       ///< States of the tasks waiting for a worker
+   int mNumMessagesHandled;
+   UtlBoolean mShuttingDown;
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+#endif  // _OsServerTaskPool_h_
@@ -16,13 +16,29 @@
 #include "utl/UtlLink.h"
 
 // DEFINES
+/// Number of chains moved between a thread's cache and the shared pool at a time.
+/**
+ * Zero disables the thread caches, so every get and release takes the pool lock.
+ */
+#ifndef UTLCHAINPOOL_CACHE_BATCH
+#define UTLCHAINPOOL_CACHE_BATCH 64
+#endif
+
 // MACROS
 // EXTERNAL FUNCTIONS
 // EXTERNAL VARIABLES
 // CONSTANTS
 // FORWARD DECLARATIONS
+class UtlChainPoolCache;
+
 // STRUCTS
 // TYPEDEFS
+#if defined(_WIN32)
+typedef unsigned long UtlChainPoolCacheKey; ///< fiber local storage index
+#else
+#  include <pthread.h>
+typedef pthread_key_t UtlChainPoolCacheKey;
+#endif
 
 /// Pool of available objects derived from UtlChain.
 /**
@@ -33,6 +49,12 @@
  *
  * The actual allocation of the blocks and initial chaining is done by the allocator
  * function supplied by the UtlChain subclass.
+ *
+ * Every container in the process gets its UtlChains here, so rather than take
+ * mLock for each one, each thread keeps a small cache of available UtlChains.
+ * The cache is refilled from mPool, and overflows back to it, cacheBatch
+ * UtlChains at a time under a single lock.  The cache of a thread is returned
+ * to mPool when the thread exits.
  */
 class UtlChainPool
 {
@@ -44,6 +66,7 @@ protected:
    friend class UtlLink;
    friend class UtlPair;
    friend class UtlInit;
+   friend class UtlChainPoolCache;
 
    /// Allocate blocksize instances of the subclass and chain them into the pool. 
    typedef void allocator(size_t    blocksize, ///< number of instances to allocate
@@ -59,7 +82,10 @@ protected:
     */
 
    /// Create a UtlChainPool that uses blockAllocator to create UtlChain derived objects.
-   UtlChainPool(allocator* blockAllocator, size_t blockSize);
+   UtlChainPool(allocator* blockAllocator,
+                size_t blockSize,
+                size_t cacheBatch = UTLCHAINPOOL_CACHE_BATCH ///< 0 for no thread caches
+                );
 
    /// Get a UtlLink with chain pointers NULL
    UtlChain* get();
@@ -83,6 +109,24 @@ private:
    /// Release all dynamic memory used by the UtlLinkPool.
    ~UtlChainPool();
 
+   /// Get the cache of the calling thread, creating it on first use.
+   UtlChainPoolCache* getCache();
+   /**<
+    * Returns NULL if thread caches are disabled or could not be set up.
+    */
+
+   /// Take one UtlChain from mPool, allocating a block if it is empty; mLock must be held.
+   UtlChain* takeFromPool();
+
+   /// Move up to mCacheBatch UtlChains from mPool into the cache.
+   void refillCache(UtlChainPoolCache* cache);
+
+   /// Move count UtlChains from the cache back to mPool.
+   void drainCache(UtlChainPoolCache* cache, size_t count);
+
+   /// Return all UtlChains in the cache of an exiting thread to mPool, and delete the cache.
+   void releaseCache(UtlChainPoolCache* cache);
+
    OsBSem        mLock; ///< lock for all the other member variables
    size_t        mBlockSize;
    size_t        mAllocations;
@@ -92,6 +136,10 @@ private:
                              *   Each block is an mBlockSize array of objects derived from
                              *   UtlChain. The 0th element is used to form the linked list
                              *   of blocks.  The rest are made a part of the mPool.*/
+   size_t        mCacheBatch;    ///< UtlChains moved to or from a cache at a time
+   bool          mCacheKeyValid; ///< mCacheKey was created, so thread caches are in use
+   UtlChainPoolCacheKey mCacheKey; ///< thread local pointer to the UtlChainPoolCache
+   UtlChain      mCaches;   ///< list of the caches of all threads
 };
 
 
@@ -40,6 +40,8 @@ const UtlString OsMsgQBase::MSGQ_PREFIX("MsgQ.");
 OsMsgQBase::OsMsgQBase(const UtlString& name)
 :  mSendHookFunc(NULL),
    mFlushHookFunc(NULL),
+   mQueuedHookFunc(NULL),
+   mpQueuedHookData(NULL),
    mName(name)
 {
    if (mName != "")
@@ -102,6 +104,13 @@ void OsMsgQBase::setSendHook(OsMsgQSendHookPtr func)
    mSendHookFunc = func;
 }
 
+// Set the function that is invoked after a msg has been put in the queue
+void OsMsgQBase::setQueuedHook(OsMsgQQueuedHookPtr func, void* pHookData)
+{
+   mpQueuedHookData = pHookData;
+   mQueuedHookFunc = func;
+}
+
 // Set the function that is invoked whenever a msg is flushed from the 
 // queue.  Messages get flushed when the OsMsgQ is deleted while there 
 // are messages still queued.
@@ -16,6 +16,7 @@
 // APPLICATION INCLUDES
 #include "os/OsServerTask.h"
 #include "os/OsMsg.h"
+#include "os/OsServerTaskPool.h"
 
 // EXTERNAL FUNCTIONS
 // EXTERNAL VARIABLES
@@ -36,7 +37,8 @@ OsServerTask::OsServerTask(const UtlString& name,
                            const int options,
                            const int stackSize)
 :  OsTask(name, pArg, priority, options, stackSize),
-   mIncomingQ(maxRequestQMsgs, OsMsgQ::DEF_MAX_MSG_LEN, OsMsgQ::Q_PRIORITY)
+   mIncomingQ(maxRequestQMsgs, OsMsgQ::DEF_MAX_MSG_LEN, OsMsgQ::Q_PRIORITY),
+   mpPool(NULL)
 
    // other than initialization, no work required
 {
@@ -119,6 +121,70 @@ void OsServerTask::requestShutdown(void)
    assert(res = OS_SUCCESS);
 }
 
+// Run this task on the worker threads of a pool instead of start().
+UtlBoolean OsServerTask::startInPool(OsServerTaskPool& rPool)
+{
+   if (mpPool != NULL || !isUnInitialized())
+   {
+      return FALSE;
+   }
+
+   mpPool = &rPool;
+   rPool.addTask(this);
+   mIncomingQ.setQueuedHook(queuedHook, this);
+
+   // Messages sent before the task joined the pool
+   if (!mIncomingQ.isEmpty())
+   {
+      rPool.scheduleTask(this);
+   }
+
+   return TRUE;
+}
+
+// Handle up to maxMessages queued messages without waiting.
+int OsServerTask::handleQueuedMessages(int maxMessages)
+{
+   int numHandled = 0;
+   OsMsg* pMsg = NULL;
+
+   while (numHandled < maxMessages &&
+          receiveMessage((OsMsg*&) pMsg, OsTime::NO_WAIT_TIME) == OS_SUCCESS)
+   {
+      // A pooled task is never started, so it goes straight to shut down
+      if (!isShuttingDown() && !isShutDown())
+      {
+         if (!handleMessage(*pMsg))
+            OsServerTask::handleMessage(*pMsg);
+      }
+
+      if (!pMsg->getSentFromISR())
+         pMsg->releaseMsg();
+
+      numHandled++;
+   }
+
+   return numHandled;
+}
+
+// Take the task out of its pool, if it has one, and wait for it to shut down.
+UtlBoolean OsServerTask::waitUntilShutDown(int milliSecToWait)
+{
+   OsServerTaskPool* pPool = mpPool;
+   if (pPool != NULL)
+   {
+      mIncomingQ.setQueuedHook(NULL, NULL);
+      pPool->removeTask(this);
+      mpPool = NULL;
+
+      // Nothing will handle these now, and a full queue would block the
+      // OS_SHUTDOWN message posted by requestShutdown()
+      mIncomingQ.flush();
+   }
+
+   return OsTask::waitUntilShutDown(milliSecToWait);
+}
+
 /* ============================ ACCESSORS ================================= */
 
 // Get the pointer to the incoming message queue
@@ -127,6 +193,12 @@ OsMsgQ* OsServerTask::getMessageQueue()
     return(&mIncomingQ);
 }
 
+// Get the pool the task runs in, NULL if it has its own thread.
+OsServerTaskPool* OsServerTask::getPool() const
+{
+   return mpPool;
+}
+
 /* ============================ INQUIRY =================================== */
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
@@ -186,4 +258,15 @@ int OsServerTask::run(void* pArg)
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 
+// Schedule a pooled task when a message is put in its queue.
+void OsServerTask::queuedHook(void* pTask)
+{
+   OsServerTask* pServerTask = (OsServerTask*) pTask;
+   OsServerTaskPool* pPool = pServerTask->mpPool;
+   if (pPool != NULL)
+   {
+      pPool->scheduleTask(pServerTask);
+   }
+}
+
 /* ============================ FUNCTIONS ================================= */
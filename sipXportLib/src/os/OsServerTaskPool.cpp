@@ -0,0 +1,298 @@
+//
+// Copyright (C) 2006-2019 SIPez LLC.  All rights reserved.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <assert.h>
+#include <stdio.h>
+
+// APPLICATION INCLUDES
+#include "os/OsServerTaskPool.h"
+#include "os/OsServerTask.h"
+#include "os/OsLock.h"
+#include "utl/UtlVoidPtr.h"
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+#define MAX_RUNNABLE_TASKS 0x7fffffff
+
+// STATIC VARIABLE INITIALIZATIONS
+
+// Private class: scheduling state of one task in the pool
+class OsServerTaskState : public UtlVoidPtr
+{
+public:
+
+   OsServerTaskState(OsServerTask* pTask)
+      : UtlVoidPtr(pTask)
+      , mScheduled(FALSE)
+      , mpRunner(NULL)
+   {
+   }
+
+   // UtlVoidPtr::getValue contains the task
+   UtlBoolean mScheduled; ///< On the run queue
+   OsTaskBase* mpRunner;  ///< Worker running the task, if any
+
+private:
+   //! DISALLOWED accidental copying
+   OsServerTaskState(const OsServerTaskState& rOsServerTaskState);
+   OsServerTaskState& operator=(const OsServerTaskState& rhs);
+};
+
+// Private class: worker thread of the pool
+class OsServerTaskPoolWorker : public OsTask
+{
+public:
+
+   OsServerTaskPoolWorker(const UtlString& name,
+                          OsServerTaskPool* pPool,
+                          const int priority,
+                          const int stackSize)
+      : OsTask(name, NULL, priority, DEF_OPTIONS, stackSize)
+      , mpPool(pPool)
+   {
+   }
+
+   virtual
+   ~OsServerTaskPoolWorker()
+   {
+      waitUntilShutDown();
+   }
+
+   virtual int run(void* pArg)
+   {
+      while (mpPool->runNextTask(this))
+      {
+      }
+      return 0;
+   }
+
+private:
+   OsServerTaskPool* mpPool;
+
+   //! DISALLOWED accidental copying
+   OsServerTaskPoolWorker(const OsServerTaskPoolWorker& rOsServerTaskPoolWorker);
+   OsServerTaskPoolWorker& operator=(const OsServerTaskPoolWorker& rhs);
+};
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+// Constructor
+OsServerTaskPool::OsServerTaskPool(const UtlString& name,
+                                   int numWorkers,
+                                   int maxMessagesPerTurn,
+                                   const int priority,
+                                   const int stackSize)
+   : mName(name)
+   , mMaxMessagesPerTurn(maxMessagesPerTurn > 0 ? maxMessagesPerTurn : 1)
+   , mNumWorkers(numWorkers > 0 ? numWorkers : 1)
+   , mpWorkers(NULL)
+   , mMutex(OsMutex::Q_FIFO)
+   , mRunnable(OsCSem::Q_FIFO, MAX_RUNNABLE_TASKS, 0)
+   , mNumMessagesHandled(0)
+   , mShuttingDown(FALSE)
+{
+   mpWorkers = new OsServerTaskPoolWorker*[mNumWorkers];
+   for (int i = 0; i < mNumWorkers; i++)
+   {
+      char workerName[32];
+      snprintf(workerName, sizeof(workerName), "-%d", i);
+      mpWorkers[i] = new OsServerTaskPoolWorker(mName + workerName, this,
+                                                priority, stackSize);
+   }
+}
+
+// Destructor
+OsServerTaskPool::~OsServerTaskPool()
+{
+   {
+      OsLock lock(mMutex);
+      mShuttingDown = TRUE;
+   }
+
+   // Wake all of the workers so they see the shut down
+   int i;
+   for (i = 0; i < mNumWorkers; i++)
+   {
+      mRunnable.release();
+   }
+   for (i = 0; i < mNumWorkers; i++)
+   {
+      delete mpWorkers[i];
+   }
+   delete[] mpWorkers;
+
+   mRunQueue.removeAll();
+   mTaskStates.destroyAll();
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+// Start the worker threads
+UtlBoolean OsServerTaskPool::start()
+{
+   UtlBoolean started = TRUE;
+   for (int i = 0; i < mNumWorkers; i++)
+   {
+      if (!mpWorkers[i]->isStarted())
+      {
+         started = mpWorkers[i]->start() && started;
+      }
+   }
+   return started;
+}
+
+// Add a task to the pool
+void OsServerTaskPool::addTask(OsServerTask* pTask)
+{
+   OsLock lock(mMutex);
+
+   UtlVoidPtr key(pTask);
+   if (mTaskStates.find(&key) == NULL)
+   {
+      mTaskStates.insert(new OsServerTaskState(pTask));
+   }
+}
+
+// Remove a task from the pool, waiting if a worker is running it
+void OsServerTaskPool::removeTask(OsServerTask* pTask)
+{
+   OsLock lock(mMutex);
+
+   UtlVoidPtr key(pTask);
+   OsServerTaskState* pState = (OsServerTaskState*) mTaskStates.find(&key);
+   if (pState)
+   {
+      // Let the worker finish its turn, unless this is the worker
+      OsTaskBase* pCurrentTask = OsTask::getCurrentTask();
+      for (;;)
+      {
+         if (pState->mScheduled)
+         {
+            // The worker woken for this entry finds the run queue empty
+            mRunQueue.removeReference(pState);
+            pState->mScheduled = FALSE;
+         }
+
+         if (pState->mpRunner == NULL || pState->mpRunner == pCurrentTask)
+         {
+            break;
+         }
+
+         mMutex.release();
+         OsTask::delay(1);
+         mMutex.acquire();
+      }
+
+      mTaskStates.removeReference(pState);
+      delete pState;
+   }
+}
+
+// Put a task with queued messages on the run queue
+void OsServerTaskPool::scheduleTask(OsServerTask* pTask)
+{
+   OsLock lock(mMutex);
+
+   UtlVoidPtr key(pTask);
+   OsServerTaskState* pState = (OsServerTaskState*) mTaskStates.find(&key);
+
+   // A running task is put back on the run queue by its worker
+   if (pState && !pState->mScheduled && pState->mpRunner == NULL &&
+       !mShuttingDown)
+   {
+      pState->mScheduled = TRUE;
+      mRunQueue.append(pState);
+      mRunnable.release();
+   }
+}
+
+/* ============================ ACCESSORS ================================= */
+
+// Number of worker threads
+int OsServerTaskPool::getNumWorkers() const
+{
+   return mNumWorkers;
+}
+
+// Number of tasks in the pool
+int OsServerTaskPool::getNumTasks()
+{
+   OsLock lock(mMutex);
+   return mTaskStates.entries();
+}
+
+// Number of messages handled by the workers so far
+int OsServerTaskPool::getNumMessagesHandled()
+{
+   OsLock lock(mMutex);
+   return mNumMessagesHandled;
+}
+
+/* ============================ INQUIRY =================================== */
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+// Run the next task on the run queue
+UtlBoolean OsServerTaskPool::runNextTask(OsServerTaskPoolWorker* pWorker)
+{
+   mRunnable.acquire();
+
+   OsServerTask* pTask = NULL;
+   {
+      OsLock lock(mMutex);
+
+      if (mShuttingDown)
+      {
+         return FALSE;
+      }
+
+      OsServerTaskState* pState = (OsServerTaskState*) mRunQueue.get();
+      if (pState == NULL)
+      {
+         // The task was removed after it was scheduled
+         return TRUE;
+      }
+
+      pState->mScheduled = FALSE;
+      pState->mpRunner = pWorker;
+      pTask = (OsServerTask*) pState->getValue();
+   }
+
+   int numHandled = pTask->handleQueuedMessages(mMaxMessagesPerTurn);
+
+   {
+      OsLock lock(mMutex);
+
+      mNumMessagesHandled += numHandled;
+
+      // The task may have been removed by its own handler
+      UtlVoidPtr key(pTask);
+      OsServerTaskState* pState = (OsServerTaskState*) mTaskStates.find(&key);
+      if (pState && pState->mpRunner == pWorker)
+      {
+         pState->mpRunner = NULL;
+
+         // Messages which came in while the task ran, or which did not fit
+         // in this turn, go to the back of the run queue
+         if (!pTask->getMessageQueue()->isEmpty() && !mShuttingDown)
+         {
+            pState->mScheduled = TRUE;
+            mRunQueue.append(pState);
+            mRunnable.release();
+         }
+      }
+   }
+
+   return TRUE;
+}
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
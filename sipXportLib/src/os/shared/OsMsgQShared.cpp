@@ -300,6 +300,13 @@ OsStatus OsMsgQShared::doSend(const OsMsg& rMsg, const OsTime& rTimeout,
       OsStatus guardRet = mGuard.release();           // exit critical section
       assert(guardRet == OS_SUCCESS);
 
+      // tell whoever services the queue that there is a msg
+      OsMsgQQueuedHookPtr queuedHookFunc = mQueuedHookFunc;
+      if (ret == OS_SUCCESS && queuedHookFunc != NULL)
+      {
+         queuedHookFunc(mpQueuedHookData);
+      }
+
 #ifdef OS_MSGQ_REPORTING
       if (increasedLevel)
       {
@@ -0,0 +1,199 @@
+//
+// Copyright (C) 2006-2019 SIPez LLC.  All rights reserved.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+// APPLICATION INCLUDES
+#include "os/OsDateTime.h"
+#include "os/OsMsg.h"
+#include "os/OsServerTask.h"
+#include "os/OsServerTaskPool.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+int externalForSideEffects;
+
+// CONSTANTS
+#define DEFAULT_IDLE_TASKS 5000
+#define DEFAULT_ACTIVE_TASKS 500
+#define POOL_WORKERS 8
+#define IDLE_SECONDS 2
+#define ACTIVE_SECONDS 3
+// Messages per second to each active task, about what a call in
+// progress gets from media notifications and signalling
+#define MESSAGES_PER_TASK_SECOND 50
+// Stack of the thread per task, the CpCall default
+#define TASK_STACK_SIZE (96 * 1024)
+
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+
+// Stand in for a call: a little work for each message
+class LoadTask : public OsServerTask
+{
+public:
+
+   LoadTask()
+   : OsServerTask("LoadTask-%d", NULL, DEF_MAX_MSGS, DEF_PRIO,
+                  DEF_OPTIONS, TASK_STACK_SIZE)
+   , mChecksum(0)
+   {}
+
+   virtual
+   ~LoadTask()
+   {
+      waitUntilShutDown();
+   }
+
+protected:
+
+   virtual UtlBoolean handleMessage(OsMsg& rMsg)
+   {
+      if (rMsg.getMsgType() != OsMsg::USER_START)
+      {
+         return FALSE;
+      }
+
+      for (int i = 0; i < 500; i++)
+      {
+         mChecksum = mChecksum * 31 + i;
+      }
+      externalForSideEffects += mChecksum & 1;
+      return TRUE;
+   }
+
+   unsigned int mChecksum;
+};
+
+// Resident memory of the process in KB
+long residentKBytes()
+{
+   long resident = 0;
+   FILE* statm = fopen("/proc/self/statm", "r");
+   if (statm)
+   {
+      long size;
+      if (fscanf(statm, "%ld %ld", &size, &resident) != 2)
+      {
+         resident = 0;
+      }
+      fclose(statm);
+   }
+   return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// CPU time used by the process in seconds
+double cpuSeconds()
+{
+   struct rusage usage;
+   getrusage(RUSAGE_SELF, &usage);
+   return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+          (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+double elapsedSeconds(const OsTime& start)
+{
+   OsTime now;
+   OsDateTime::getCurTime(now);
+   return (now - start).getDouble();
+}
+
+// Create, idle and load tasks with a thread each, or in a pool
+void runLoad(OsServerTaskPool* pPool, int numIdle, int numActive)
+{
+   int numTasks = numIdle > numActive ? numIdle : numActive;
+   LoadTask** tasks = new LoadTask*[numTasks];
+   int i;
+
+   long memoryBefore = residentKBytes();
+   for (i = 0; i < numTasks; i++)
+   {
+      tasks[i] = new LoadTask();
+      if (!(pPool ? tasks[i]->startInPool(*pPool) : tasks[i]->start()))
+      {
+         printf("  could only start %d tasks\n", i);
+         delete tasks[i];
+         numTasks = i;
+         break;
+      }
+   }
+   // Let the new threads settle
+   OsTask::delay(500);
+   long memoryAfter = residentKBytes();
+
+   printf("%s: %d tasks\n", pPool ? "Thread pool" : "Thread per task", numTasks);
+   printf("  memory per task        %8.1f KB\n",
+          numTasks ? (double) (memoryAfter - memoryBefore) / numTasks : 0.0);
+
+   OsTime start;
+   OsDateTime::getCurTime(start);
+   double cpuStart = cpuSeconds();
+   OsTask::delay(IDLE_SECONDS * 1000);
+   printf("  idle CPU               %8.1f %%\n",
+          100 * (cpuSeconds() - cpuStart) / elapsedSeconds(start));
+
+   // Post to the active tasks at a steady rate in 10 msec ticks
+   if (numActive > numTasks)
+   {
+      numActive = numTasks;
+   }
+   OsMsg msg(OsMsg::USER_START, 0);
+   int ticks = ACTIVE_SECONDS * 100;
+   int perTick = numActive * MESSAGES_PER_TASK_SECOND / 100;
+   int next = 0;
+   int numSent = 0;
+   OsDateTime::getCurTime(start);
+   cpuStart = cpuSeconds();
+   for (int tick = 0; tick < ticks; tick++)
+   {
+      for (int sent = 0; sent < perTick; sent++)
+      {
+         if (tasks[next]->postMessage(msg, OsTime::NO_WAIT_TIME) == OS_SUCCESS)
+         {
+            numSent++;
+         }
+         next = (next + 1) % numActive;
+      }
+      OsTask::delay(10);
+   }
+   double seconds = elapsedSeconds(start);
+   printf("  %d active tasks CPU   %8.1f %%, %.0f messages per second\n",
+          numActive, 100 * (cpuSeconds() - cpuStart) / seconds,
+          numSent / seconds);
+
+   for (i = 0; i < numTasks; i++)
+   {
+      delete tasks[i];
+   }
+   delete[] tasks;
+}
+
+// Memory and CPU of many mostly idle server tasks (the call tasks of a
+// busy user agent) run with a thread each and in a thread pool.
+//
+// usage: OsServerTaskPoolPerformance [idleTasks [activeTasks]]
+int main(int argc, char* argv[])
+{
+   int numIdle = argc > 1 ? atoi(argv[1]) : DEFAULT_IDLE_TASKS;
+   int numActive = argc > 2 ? atoi(argv[2]) : DEFAULT_ACTIVE_TASKS;
+
+   OsServerTaskPool* pPool = new OsServerTaskPool("LoadPool", POOL_WORKERS);
+   pPool->start();
+   runLoad(pPool, numIdle, numActive);
+   delete pPool;
+
+   runLoad(NULL, numIdle, numActive);
+
+   return 0;
+}
@@ -0,0 +1,175 @@
+//
+// Copyright (C) 2006-2019 SIPez LLC.  All rights reserved.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <os/OsServerTask.h>
+#include <os/OsServerTaskPool.h>
+#include <os/OsAtomics.h>
+#include <os/OsMsg.h>
+#include <sipxunittests.h>
+
+#define NUM_POOL_WORKERS 4
+#define NUM_POOLED_TASKS 50
+#define NUM_TASK_MESSAGES 200
+
+/// Server task which counts its messages and checks it is never run twice at once
+class PooledCountingTask : public OsServerTask
+{
+public:
+
+   PooledCountingTask()
+   : OsServerTask("PooledCountingTask-%d")
+   , mInHandler(0)
+   , mOverlaps(0)
+   , mHandled(0)
+   {}
+
+   virtual
+   ~PooledCountingTask()
+   {
+      waitUntilShutDown();
+   }
+
+   OsAtomicInt mInHandler;
+   OsAtomicInt mOverlaps;
+   OsAtomicInt mHandled;
+
+protected:
+
+   virtual UtlBoolean handleMessage(OsMsg& rMsg)
+   {
+      if (rMsg.getMsgType() != OsMsg::USER_START)
+      {
+         return FALSE;
+      }
+
+      if (++mInHandler > 1)
+      {
+         mOverlaps++;
+      }
+      // Give another worker the chance to run this task too, if it could
+      if (mHandled % 50 == 0)
+      {
+         OsTask::yield();
+      }
+      mHandled++;
+      mInHandler--;
+
+      return TRUE;
+   }
+};
+
+class OsServerTaskPoolTest : public SIPX_UNIT_BASE_CLASS
+{
+   CPPUNIT_TEST_SUITE(OsServerTaskPoolTest);
+   CPPUNIT_TEST(testSerializedHandling);
+   CPPUNIT_TEST(testQueuedBeforeStart);
+   CPPUNIT_TEST(testShutdownWithQueuedMessages);
+   CPPUNIT_TEST_SUITE_END();
+
+   // Wait up to five seconds for the pool to handle the given number of messages
+   UtlBoolean waitForMessages(OsServerTaskPool& pool, int numMessages)
+   {
+      for (int i = 0; i < 500 && pool.getNumMessagesHandled() < numMessages; i++)
+      {
+         OsTask::delay(10);
+      }
+      return pool.getNumMessagesHandled() >= numMessages;
+   }
+
+public:
+
+   void testSerializedHandling()
+   {
+      OsServerTaskPool pool("TestPool", NUM_POOL_WORKERS, 8);
+      CPPUNIT_ASSERT(pool.start());
+      CPPUNIT_ASSERT_EQUAL(NUM_POOL_WORKERS, pool.getNumWorkers());
+
+      PooledCountingTask* tasks[NUM_POOLED_TASKS];
+      int i;
+      for (i = 0; i < NUM_POOLED_TASKS; i++)
+      {
+         tasks[i] = new PooledCountingTask();
+         CPPUNIT_ASSERT(tasks[i]->startInPool(pool));
+         CPPUNIT_ASSERT(tasks[i]->getPool() == &pool);
+         // The task has no thread of its own
+         CPPUNIT_ASSERT(!tasks[i]->isStarted());
+      }
+      CPPUNIT_ASSERT_EQUAL(NUM_POOLED_TASKS, pool.getNumTasks());
+
+      // Can only be started once
+      CPPUNIT_ASSERT(!tasks[0]->startInPool(pool));
+
+      OsMsg msg(OsMsg::USER_START, 0);
+      for (int message = 0; message < NUM_TASK_MESSAGES; message++)
+      {
+         for (i = 0; i < NUM_POOLED_TASKS; i++)
+         {
+            CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, tasks[i]->postMessage(msg));
+         }
+      }
+
+      CPPUNIT_ASSERT(waitForMessages(pool, NUM_POOLED_TASKS * NUM_TASK_MESSAGES));
+      CPPUNIT_ASSERT_EQUAL(NUM_POOLED_TASKS * NUM_TASK_MESSAGES,
+                           pool.getNumMessagesHandled());
+
+      for (i = 0; i < NUM_POOLED_TASKS; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL(NUM_TASK_MESSAGES, (int) tasks[i]->mHandled);
+         CPPUNIT_ASSERT_EQUAL(0, (int) tasks[i]->mOverlaps);
+         delete tasks[i];
+      }
+      CPPUNIT_ASSERT_EQUAL(0, pool.getNumTasks());
+   }
+
+   void testQueuedBeforeStart()
+   {
+      OsServerTaskPool pool("TestPool", 1);
+      CPPUNIT_ASSERT(pool.start());
+
+      PooledCountingTask task;
+      OsMsg msg(OsMsg::USER_START, 0);
+      task.postMessage(msg);
+      task.postMessage(msg);
+
+      CPPUNIT_ASSERT(task.startInPool(pool));
+      CPPUNIT_ASSERT(waitForMessages(pool, 2));
+      CPPUNIT_ASSERT_EQUAL(2, (int) task.mHandled);
+   }
+
+   void testShutdownWithQueuedMessages()
+   {
+      OsServerTaskPool pool("TestPool", 2, 1);
+      CPPUNIT_ASSERT(pool.start());
+
+      for (int i = 0; i < 20; i++)
+      {
+         PooledCountingTask* task = new PooledCountingTask();
+         task->startInPool(pool);
+
+         OsMsg msg(OsMsg::USER_START, 0);
+         for (int message = 0; message < 100; message++)
+         {
+            task->postMessage(msg);
+         }
+
+         // Destroyed while a worker may be running it
+         delete task;
+         CPPUNIT_ASSERT_EQUAL(0, pool.getNumTasks());
+      }
+
+      // Messages to a shut down task are dropped
+      PooledCountingTask task;
+      task.startInPool(pool);
+      task.requestShutdown();
+      CPPUNIT_ASSERT(task.isShutDown());
+      OsMsg msg(OsMsg::USER_START, 0);
+      task.postMessage(msg);
+      OsTask::delay(50);
+      CPPUNIT_ASSERT_EQUAL(0, (int) task.mHandled);
+   }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OsServerTaskPoolTest);
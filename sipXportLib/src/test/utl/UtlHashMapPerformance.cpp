@@ -10,6 +10,7 @@
 
 // SYSTEM INCLUDES
 #include "assert.h"
+#include <stdio.h>
 
 // APPLICATION INCLUDES
 
@@ -17,8 +18,8 @@
 #include "utl/UtlInt.h"
 #include "utl/UtlHashMap.h"
 #include "utl/UtlHashMapIterator.h"
+#include "os/OsDateTime.h"
 #include "os/OsTask.h"
-#include "os/OsTimeLog.h"
 
 // DEFINES
 // MACROS
@@ -28,7 +29,9 @@ int externalForSideEffects;
 
 // CONSTANTS
 // comparison base values
-#define NUM_THREADS 5
+#define MAX_THREADS 16
+// Each thread repeats the operations this many times
+#define RUNS_PER_THREAD 10
 
 // STRUCTS
 // TYPEDEFS
@@ -37,23 +40,16 @@ void doHashMapOperations();
 
 #include "UtlPerformanceStrings.h"
 
-OsTimeLog timer((NUM_THREADS + 1) * 2);
-
 class doTestThread : public OsTask
 {
 public:
    int run(void* taskArg)
       {
-         char mynum[3];
-         sprintf(mynum, "%02d", getUserData());
-         UtlString startMsg("  start  ");
-         UtlString finishMsg("  finish ");
-         startMsg.append(mynum);
-         finishMsg.append(mynum);
-
-         timer.addEvent(startMsg.data());
-         doHashMapOperations();
-         timer.addEvent(finishMsg.data());
+         for (int run = 0; run < RUNS_PER_THREAD; run++)
+         {
+            doHashMapOperations();
+         }
+         OsDateTime::getCurTime(mFinished);
          return 0;
       }
 
@@ -62,41 +58,71 @@ public:
          this->OsTask::waitUntilShutDown();
          return TRUE;
       }
+
+   OsTime mFinished;
 };
 
-int main()
+// Run the operations on numThreads threads at once, returning the seconds taken
+double runThreads(int numThreads)
 {
-   doTestThread* threads[NUM_THREADS];
+   doTestThread* threads[MAX_THREADS];
    int n;
 
-   UtlSList dummy;
-   
-   setupStrings();
-   
-   for (n = 0; n < NUM_THREADS; n++)
+   for (n = 0; n < numThreads; n++)
    {
-      threads[n]   = new doTestThread;
+      threads[n] = new doTestThread;
       threads[n]->setUserData(n);
    }
-   
-   timer.addEvent("All Start");
 
-   for (n = 0; n < NUM_THREADS; n++)
+   OsTime start;
+   OsDateTime::getCurTime(start);
+
+   for (n = 0; n < numThreads; n++)
    {
       threads[n]->start();
    }
 
-   for (n = 0; n < NUM_THREADS; n++)
+   // Not the time waitUntilShutDown() returns, it polls
+   OsTime end(start);
+   for (n = 0; n < numThreads; n++)
    {
       threads[n]->waitUntilShutDown();
+      if (threads[n]->mFinished > end)
+      {
+         end = threads[n]->mFinished;
+      }
+      delete threads[n];
    }
 
-   timer.addEvent("Done");
+   return (end - start).getDouble();
+}
 
-   osPrintf("UtlHashMap Performance v=%s %s:\n",
-            SipXportlibVersion, SipXportlibBuildStamp
-            );
-   timer.dumpLog();
+// Every thread does the same work, so with no contention on the shared
+// pools of UtlLinks and UtlPairs the runs per second scale with the threads
+// (up to the number of CPUs).
+int main()
+{
+   UtlSList dummy;
+   
+   setupStrings();
+   
+   printf("UtlHashMap Performance v=%s %s:\n",
+          SipXportlibVersion, SipXportlibBuildStamp
+          );
+
+   double singleRate = 0.0;
+   for (int numThreads = 1; numThreads <= MAX_THREADS; numThreads *= 2)
+   {
+      double seconds = runThreads(numThreads);
+      double rate = seconds > 0 ? numThreads * RUNS_PER_THREAD / seconds : 0.0;
+      if (numThreads == 1)
+      {
+         singleRate = rate;
+      }
+      printf("  %2d threads: %8.3f seconds, %8.1f runs per second, scaling %5.2f\n",
+             numThreads, seconds, rate,
+             singleRate > 0 ? rate / singleRate : 0.0);
+   }
 
    return 0;
 }
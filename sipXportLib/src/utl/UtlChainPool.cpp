@@ -9,6 +9,10 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 // SYSTEM INCLUDES
+#if defined(_WIN32)
+#  include <windows.h>
+#endif
+
 // APPLICATION INCLUDES
 #include "os/OsLock.h"
 #include "utl/UtlChainPool.h"
@@ -22,56 +26,248 @@
 // GLOBAL VARIABLES
 // GLOBAL FUNCTIONS
 
+/// The UtlChains available to one thread, used without any lock.
+/**
+ * The cache itself is chained on the mCaches list of its pool.
+ * Its UtlChains are kept in a queue linked through their next pointers,
+ * with prev left NULL, so that a UtlChain taken off it is unlinked.
+ * Like mPool it is first in, first out: links freed in order are reused
+ * in order, which keeps the lists built from them close in memory.
+ */
+class UtlChainPoolCache : public UtlChain
+{
+public:
+   UtlChainPoolCache(UtlChainPool* pool) :
+      mpPool(pool),
+      mpHead(NULL),
+      mpTail(NULL),
+      mCount(0)
+      {
+      }
+
+   /// Called for the cache of each thread as the thread exits.
+#if defined(_WIN32)
+   static VOID WINAPI threadExit(PVOID cache)
+#else
+   static void threadExit(void* cache)
+#endif
+      {
+         if (cache)
+         {
+            UtlChainPoolCache* threadCache = static_cast<UtlChainPoolCache*>(cache);
+            threadCache->mpPool->releaseCache(threadCache);
+         }
+      }
+
+   UtlChainPool* mpPool;
+   UtlChain*     mpHead; ///< next available UtlChain
+   UtlChain*     mpTail; ///< last available UtlChain
+   size_t        mCount; ///< number of UtlChains in the queue
+};
+
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
-UtlChainPool::UtlChainPool( allocator* blockAllocator, size_t blockSize ) :
+UtlChainPool::UtlChainPool( allocator* blockAllocator, size_t blockSize, size_t cacheBatch ) :
       mLock(OsBSem::Q_PRIORITY, OsBSem::FULL),
       mBlockSize(blockSize),
       mAllocations(0),
-      mAllocator(blockAllocator)
+      mAllocator(blockAllocator),
+      mCacheBatch(cacheBatch),
+      mCacheKeyValid(false)
 {
-
+   if (mCacheBatch > 0)
+   {
+#if defined(_WIN32)
+      mCacheKey = FlsAlloc(UtlChainPoolCache::threadExit);
+      mCacheKeyValid = (mCacheKey != FLS_OUT_OF_INDEXES);
+#else
+      mCacheKeyValid = (pthread_key_create(&mCacheKey, UtlChainPoolCache::threadExit) == 0);
+#endif
+   }
 }
 
 UtlChain* UtlChainPool::get()
 {
    UtlChain* newChain;
+
+   UtlChainPoolCache* cache = getCache();
+   if (cache)
+   {
+      if (!cache->mpHead)
+      {
+         refillCache(cache);
+      }
+
+      // pull the first UtlChain off the cache
+      newChain = cache->mpHead;
+      cache->mpHead = newChain->next;
+      cache->mCount--;
+      newChain->next = NULL;
+   }
+   else
    {  // critical section for member variables
       OsLock poolLock(mLock);
 
-      if (mPool.isUnLinked()) // are there available objects in the pool?
+      newChain = takeFromPool();
+   }  // end of critical section
+   return newChain;
+}
+
+void UtlChainPool::release( UtlChain* freeChain )
+{
+   UtlChainPoolCache* cache = getCache();
+   if (cache)
+   {
+      // put it on the tail of the cache, and if that holds two batches give one back
+      if (cache->mpHead)
       {
-         // no - get the subclass to allocate some more
-         mAllocator(mBlockSize, &mBlocks, &mPool);
-         mAllocations++;
-      } 
-
-      // pull the first UtlChain off the mPool
-      newChain = mPool.listHead();
-      if (newChain)
+         cache->mpTail->next = freeChain;
+      }
+      else
       {
-         newChain->detachFromList(&mPool);
+         cache->mpHead = freeChain;
       }
-   }  // end of critical section
+      cache->mpTail = freeChain;
+      if (++cache->mCount >= 2 * mCacheBatch)
+      {
+         drainCache(cache, mCacheBatch);
+      }
+   }
+   else
+   {
+      OsLock poolLock(mLock);
+
+      // put this freed object on the tail of the pool list
+      freeChain->listBefore(&mPool, NULL);
+   }
+}
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+UtlChainPoolCache* UtlChainPool::getCache()
+{
+   UtlChainPoolCache* cache = NULL;
+
+   if (mCacheKeyValid)
+   {
+#if defined(_WIN32)
+      cache = static_cast<UtlChainPoolCache*>(FlsGetValue(mCacheKey));
+#else
+      cache = static_cast<UtlChainPoolCache*>(pthread_getspecific(mCacheKey));
+#endif
+      if (!cache)
+      {
+         cache = new UtlChainPoolCache(this);
+#if defined(_WIN32)
+         bool isSet = (FlsSetValue(mCacheKey, cache) != 0);
+#else
+         bool isSet = (pthread_setspecific(mCacheKey, cache) == 0);
+#endif
+         if (isSet)
+         {
+            OsLock poolLock(mLock);
+
+            cache->listBefore(&mCaches, NULL);
+         }
+         else
+         {
+            delete cache;
+            cache = NULL;
+         }
+      }
+   }
+
+   return cache;
+}
+
+UtlChain* UtlChainPool::takeFromPool()
+{
+   if (mPool.isUnLinked()) // are there available objects in the pool?
+   {
+      // no - get the subclass to allocate some more
+      mAllocator(mBlockSize, &mBlocks, &mPool);
+      mAllocations++;
+   } 
+
+   // pull the first UtlChain off the mPool
+   UtlChain* newChain = mPool.listHead();
+   if (newChain)
+   {
+      newChain->detachFromList(&mPool);
+   }
    return newChain;
 }
 
-void UtlChainPool::release( UtlChain* freeChain )
+void UtlChainPool::refillCache(UtlChainPoolCache* cache)
+{
+   OsLock poolLock(mLock);
+
+   // only called when the cache is empty
+   for (size_t i = 0; i < mCacheBatch; i++)
+   {
+      UtlChain* newChain = takeFromPool();
+      if (cache->mpHead)
+      {
+         cache->mpTail->next = newChain;
+      }
+      else
+      {
+         cache->mpHead = newChain;
+      }
+      cache->mpTail = newChain;
+   }
+   cache->mCount += mCacheBatch;
+}
+
+void UtlChainPool::drainCache(UtlChainPoolCache* cache, size_t count)
 {
    OsLock poolLock(mLock);
 
-   // put this freed object on the tail of the pool list
-   freeChain->listBefore(&mPool, NULL);
+   // the oldest ones, from the head of the cache
+   for (; count > 0 && cache->mpHead; count--)
+   {
+      UtlChain* freeChain = cache->mpHead;
+      cache->mpHead = freeChain->next;
+      cache->mCount--;
+      freeChain->next = NULL;
+      freeChain->listBefore(&mPool, NULL);
+   }
 }
 
-/* //////////////////////////// PRIVATE /////////////////////////////////// */
+void UtlChainPool::releaseCache(UtlChainPoolCache* cache)
+{
+   drainCache(cache, cache->mCount);
+   {
+      OsLock poolLock(mLock);
+
+      cache->detachFromList(&mCaches);
+   }
+   delete cache;
+}
 
 UtlChainPool::~UtlChainPool()
 {
+   // No more thread exit callbacks; the caches of live threads are deleted below
+   if (mCacheKeyValid)
+   {
+#if defined(_WIN32)
+      FlsFree(mCacheKey);
+#else
+      pthread_key_delete(mCacheKey);
+#endif
+   }
+
    OsLock poolLock(mLock);
 
+   UtlChain* cache;
+   while (!mCaches.isUnLinked())
+   {
+      cache = mCaches.listHead()->detachFromList(&mCaches);
+      delete static_cast<UtlChainPoolCache*>(cache);
+   }
+
    UtlChain* block;
    while (!mBlocks.isUnLinked()) // blocks still on block list
    {
@@ -105,6 +105,7 @@ LOCAL_SRC_FILES := \
   src/net/SipPublishServerEventStateCompositor.cpp \
   src/net/SipPublishServerEventStateMgr.cpp \
   src/net/SipRefreshManager.cpp \
+  src/net/SipRefreshScheduler.cpp \
   src/net/SipRefreshMgr.cpp \
   src/net/SipRequestContext.cpp \
   src/net/SipResourceList.cpp \
@@ -202,10 +203,12 @@ LOCAL_SRC_FILES := \
     src/test/net/SipDialogEventTest.cpp \
     src/test/net/SipDialogMonitorTest.cpp \
     src/test/net/SipDialogTest.cpp \
+    src/test/net/SipLineListTest.cpp \
     src/test/net/SipMessageTest.cpp \
     src/test/net/SipPresenceEventTest.cpp \
     src/test/net/SipProxyMessageTest.cpp \
     src/test/net/SipPublishContentMgrTest.cpp \
+    src/test/net/SipRefreshSchedulerTest.cpp \
     src/test/net/SipRefreshManagerTest.cpp \
     src/test/net/SipServerShutdownTest.cpp \
     src/test/net/SipSrvLookupTest.cpp \
@@ -301,10 +304,12 @@ LOCAL_SRC_FILES := \
     src/test/net/SipDialogEventTest.cpp \
     src/test/net/SipDialogMonitorTest.cpp \
     src/test/net/SipDialogTest.cpp \
+    src/test/net/SipLineListTest.cpp \
     src/test/net/SipMessageTest.cpp \
     src/test/net/SipPresenceEventTest.cpp \
     src/test/net/SipProxyMessageTest.cpp \
     src/test/net/SipPublishContentMgrTest.cpp \
+    src/test/net/SipRefreshSchedulerTest.cpp \
     src/test/net/SipRefreshManagerTest.cpp \
     src/test/net/SipServerShutdownTest.cpp \
     src/test/net/SipSrvLookupTest.cpp \
@@ -356,6 +356,22 @@ public:
     static OsAtomicInt smHttpMessageCount;
     static int getHttpMessageCount();
 
+    //! Get the process wide getBytes() serialization counters
+    /*! \param serializeCount - number of times a message was actually
+     *         serialized
+     *  \param cacheHitCount - number of times getBytes() was served from
+     *         the serialized bytes cache
+     */
+    static void getSerializationCounts(unsigned long& serializeCount,
+                                       unsigned long& cacheHitCount);
+
+    //! Version of the message content
+    /*! Incremented by every mutation of the first header line, the
+     *  headers or the body.  Two calls returning the same value guarantee
+     *  getBytes() returns the same bytes.
+     */
+    unsigned int getMessageVersion() const;
+
     const char* getFirstHeaderLine() const;
 
     //! Set the header line
@@ -542,6 +558,11 @@ public:
     /*! Suitable for streaming or sending over a socket
      * \param bytes - gets allocated and must be freed
      * \param length - the length of bytes
+     *
+     * The serialized bytes are cached and reused until the message is
+     * modified, so retransmissions and logging of an unchanged message
+     * do not serialize it again.  Bodies must be replaced with setBody()
+     * rather than modified in place once the message has been serialized.
      */
     void getBytes(UtlString* bytes, int* length) const;
 
@@ -712,11 +733,25 @@ public:
 protected:
    UtlDList mNameValues;
    UtlString mFirstHeaderLine;
-   UtlBoolean mHeaderCacheClean;
+
+   //! Mark the serialized bytes cache stale
+   /*! Must be called by every method which modifies mNameValues,
+    *  mFirstHeaderLine or the body.
+    */
+   void invalidateBytesCache() { mMessageVersion++; };
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
 
+   static OsAtomicULong smSerializeCount;
+   static OsAtomicULong smBytesCacheHitCount;
+
+   unsigned int mMessageVersion;       ///< Bumped by invalidateBytesCache()
+   mutable unsigned int mBytesCacheVersion; ///< mMessageVersion mBytesCache was built from
+   mutable const HttpBody* mpBytesCacheBody; ///< Body mBytesCache was built from
+   mutable int mBytesCacheBodyLength;  ///< Length of that body at the time
+   mutable UtlString mBytesCache;      ///< Serialized message
+
    HttpBody* body;
    long transportTimeStamp;
    int lastResendDuration;
@@ -734,6 +769,9 @@ private:
    //! Internal utility
    NameValuePair* getHeaderField(int index, const char* name = NULL) const;
 
+   //! Is mBytesCache up to date with the message content
+   UtlBoolean isBytesCacheValid() const;
+
 
 };
 
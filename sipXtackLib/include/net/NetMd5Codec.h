@@ -17,6 +17,7 @@
 
 // APPLICATION INCLUDES
 #include <utl/UtlString.h>
+#include <os/OsIntTypes.h>
 
 // DEFINES
 // MACROS
@@ -24,13 +25,25 @@
 // EXTERNAL VARIABLES
 // CONSTANTS
 const size_t MD5_SIZE = 32;
+const size_t MD5_BIN_SIZE = 16;
 
 // STRUCTS
+
+/* MD5 context. */
+typedef struct {
+   uint32_t state[4];                                /* state (ABCD) */
+   uint32_t count[2];     /* number of bits, modulo 2^64 (lsb first) */
+   unsigned char buffer[64];                         /* input buffer */
+} MD5_CTX_PT;
+
 // TYPEDEFS
 // FORWARD DECLARATIONS
 
-//:Class short description which may consist of multiple lines (note the ':')
-// Class detailed description which may extend to multiple lines
+//:MD5 hashing with hexadecimal encoding of the result
+// The static encode() hashes a single string.  An instance hashes its
+// input incrementally: each hash() call adds more data, so a digest over
+// several fields can be computed without concatenating them first.
+// Instances may be copied, e.g. to reuse a hash of a common prefix.
 class NetMd5Codec
 {
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
@@ -39,8 +52,7 @@ public:
 /* ============================ CREATORS ================================== */
 
    NetMd5Codec();
-     //:Default constructor
-
+     //:Default constructor, ready to hash input
 
    virtual
    ~NetMd5Codec();
@@ -49,6 +61,29 @@ public:
 /* ============================ MANIPULATORS ============================== */
 
    static void encode(const char* test, UtlString& encodedText);
+     //:Append the hexadecimal MD5 hash of a null terminated string
+
+   void hash(const char* data, size_t length);
+     //:Add data to the input being hashed
+
+   void hash(const UtlString& data);
+     //:Add the contents of a string to the input being hashed
+
+   void getHashValue(unsigned char digest[MD5_BIN_SIZE]);
+     //:Finish hashing and return the binary hash value
+     // The input is reset, so the instance may be used for a new hash.
+
+   void getEncodedHashValue(char encodedText[MD5_SIZE + 1]);
+     //:Finish hashing and return the null terminated hexadecimal hash value
+     // The input is reset, so the instance may be used for a new hash.
+
+   void appendHashValue(UtlString& encodedText);
+     //:Finish hashing and append the hexadecimal hash value to encodedText
+     // The input is reset, so the instance may be used for a new hash.
+
+   static void encodeHex(const unsigned char digest[MD5_BIN_SIZE],
+                         char encodedText[MD5_SIZE + 1]);
+     //:Convert a binary hash value to null terminated lower case hexadecimal
 
 /* ============================ ACCESSORS ================================= */
 
@@ -59,11 +94,7 @@ protected:
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
-   NetMd5Codec(const NetMd5Codec& rNetMd5Codec);
-     //:Copy constructor (disabled)
-
-   NetMd5Codec& operator=(const NetMd5Codec& rhs);
-     //:Assignment operator (disabled)
+   MD5_CTX_PT mContext;
 
 };
 
@@ -86,7 +86,7 @@ public:
     //: Determine if this line is a device line.  Presently, a line is
     //  considered a device line if it's user is "Device"
 
-        UtlBoolean IsDuplicateRealm(const UtlString realm , const UtlString scheme = HTTP_DIGEST_AUTHENTICATION);
+        UtlBoolean IsDuplicateRealm(const UtlString& realm , const UtlString& scheme = HTTP_DIGEST_AUTHENTICATION);
 
         UtlString& getLineId();
 
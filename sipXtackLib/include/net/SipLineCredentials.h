@@ -31,6 +31,8 @@ public:
         void getUserId(UtlString* UserId);
         void getPasswordToken(UtlString* passToken);
         void getType(UtlString* type);
+        void getPasswordDigest(UtlString* passwordDigest);
+        //: Get the MD5 of user id, realm and password (HA1) for this realm
 
 private:
 
@@ -38,6 +40,7 @@ private:
         UtlString mPasswordToken;
         UtlString mUserId;
         UtlString mRealm;
+        UtlString mPasswordDigest;
 
 };
 
@@ -16,6 +16,8 @@
 
 // APPLICATION INCLUDES
 #include <os/OsLockingList.h>
+#include <utl/UtlHashMap.h>
+#include <utl/UtlSList.h>
 #include <net/SipLine.h>
 #include <os/OsRWMutex.h>
 #include <os/OsReadLock.h>
@@ -30,6 +32,12 @@
 // TYPEDEFS
 // FORWARD DECLARATIONS
 
+//: List of lines, indexed for lookup by line id, identity and user
+// Lookups by line id, identity, identity user id and line user are
+// hash lookups rather than walks of the list.  A line's realm is
+// checked against its credentials, which are themselves hashed by
+// realm.  Lines modified in place while in the list (identity or user)
+// must be followed by a call to updateIndex.
 class SipLineList
 {
 public:
@@ -61,8 +69,29 @@ public:
         virtual ~SipLineList();
         void dumpLines();
 
+   void updateIndex();
+   //: Rebuild the lookup indices after a line in the list was modified
+
 protected:
         OsLockingList m_LineList;
+
+   OsRWMutex mIndexLock;
+   UtlHashMap mLineIdIndex;    // line id -> UtlSList of UtlVoidPtr(SipLine*)
+   UtlHashMap mIdentityIndex;  // identity user@host:port -> lines
+   UtlHashMap mUserIdIndex;    // identity user id -> lines
+   UtlHashMap mUserIndex;      // line user (owner) -> lines
+   // Each list of lines is in the order the lines were added
+
+private:
+   void indexLine(SipLine* line);
+   void unindexLine(SipLine* line);
+   void clearIndex();
+
+   static void addToIndex(UtlHashMap& index, const UtlString& key, SipLine* line);
+   static void removeFromIndex(UtlHashMap& index, const UtlString& key, SipLine* line);
+   static UtlSList* getIndexed(UtlHashMap& index, const UtlString& key);
+   static void clearIndex(UtlHashMap& index);
+   static void getIdentityKey(const Url& identity, UtlString& key);
 };
 
 #endif // !defined(AFX_SIPLINELIST_H__3822B7DD_69A6_44FC_B936_B75FACC65DC2__INCLUDED_)
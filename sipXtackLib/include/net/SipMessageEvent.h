@@ -17,6 +17,7 @@
 // APPLICATION INCLUDES
 #include <net/SipMessage.h>
 #include <os/OsMsg.h>
+#include <os/OsMsgQ.h>
 
 // DEFINES
 // MACROS
@@ -26,9 +27,15 @@
 // STRUCTS
 // TYPEDEFS
 // FORWARD DECLARATIONS
-
-//:Class short description which may consist of multiple lines (note the ':')
-// Class detailed description which may extend to multiple lines
+class SipMessageEventShare;
+
+//:Event carrying a SipMessage to a message queue
+// The message is owned by the event.  Copies of the event made by
+// createCopy() (e.g. when posted to several observer queues) share one
+// reference counted, read only SipMessage instead of deep copying it.
+// A holder which needs to modify the message must use
+// getMessageForWrite(), which makes a private copy if the message is
+// shared.
 class SipMessageEvent : public OsMsg
 {
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
@@ -56,8 +63,18 @@ public:
      //:Destructor
 
    virtual OsMsg* createCopy(void) const;
+     //:Create a copy of the event sharing the same SipMessage
+
 /* ============================ MANIPULATORS ============================== */
 
+SipMessage* getMessageForWrite();
+  //:Get a modifiable message, copying it first if it is shared
+
+OsStatus postToObserver(OsMsgQ& observerQueue, void* observerData);
+  //:Post a copy of the event to an observer queue
+  // Observers get their observer data back as the response listener
+  // data of the message.  The posted copy shares the message when the
+  // data already matches, otherwise it carries a private copy.
 
 /* ============================ ACCESSORS ================================= */
 const SipMessage* getMessage();
@@ -67,14 +84,23 @@ int getMessageStatus() const;
 
 /* ============================ INQUIRY =================================== */
 
+UtlBoolean isMessageShared() const;
+  //:Is the message shared with other copies of this event
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
-        SipMessage* sipMessage;
+        SipMessageEventShare* mpShare;
         int messageStatus;
 
+   SipMessageEvent(SipMessageEventShare* share, int status);
+     //:Constructor for copies sharing the message of another event
+
+   void releaseShare();
+     //:Drop the reference to the message, deleting it with the last one
+
    SipMessageEvent(const SipMessageEvent& rSipMessageEvent);
      //:disable Copy constructor
 
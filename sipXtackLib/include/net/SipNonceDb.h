@@ -16,8 +16,7 @@
 
 // APPLICATION INCLUDES
 #include <utl/UtlString.h>
-#include <utl/UtlHashBag.h>
-#include "os/OsBSem.h"
+#include <net/NetMd5Codec.h>
 
 // DEFINES
 // MACROS
@@ -28,8 +27,10 @@
 // TYPEDEFS
 // FORWARD DECLARATIONS
 
-//:Class short description which may consist of multiple lines (note the ':')
-// Class detailed description which may extend to multiple lines
+//:Creates and validates Digest authentication nonces
+// Nonces are stateless: each carries its creation time and an HMAC-MD5
+// signature binding it to the call, so nothing is stored per nonce and
+// no lock is needed to create or validate one.
 class SipNonceDb
 {
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
@@ -53,6 +54,7 @@ public:
                        UtlString& nonce); // output
 
    void removeOldNonces(long oldTime);
+     //:No-op kept for compatibility; nonces are not stored
 
 /* ============================ ACCESSORS ================================= */
 
@@ -63,7 +65,7 @@ public:
                           const UtlString& fromTag,
                           const UtlString& uri,
                           const UtlString& realm,
-                          const long expiredTime);
+                          const long expiredTime) const;
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
@@ -76,15 +78,16 @@ private:
    SipNonceDb& operator=(const SipNonceDb& rhs);
      //:Assignment operator
 
-   UtlString nonceSignature(const UtlString& callId,
-                                                   const UtlString& uri,
-                                                   const UtlString& fromTag,
-                           const UtlString& realm,
-                                                   const UtlString& timestamp
-                           );
+   void nonceSignature(const UtlString& callId,
+                       const UtlString& fromTag,
+                       const UtlString& realm,
+                       const char* timestamp,
+                       size_t timestampLength,
+                       char signature[MD5_SIZE + 1]
+                       ) const;
 
-   UtlHashBag mNonceHash;
-   UtlString    mNonceSignatureSecret;
+   NetMd5Codec mInnerPadHash; ///< MD5 state after hashing the inner HMAC pad
+   NetMd5Codec mOuterPadHash; ///< MD5 state after hashing the outer HMAC pad
 
 };
 
@@ -98,7 +101,6 @@ class SharedNonceDb : public SipNonceDb
    
   private:
    
-   static OsBSem*     spLock;
    static SipNonceDb* spSipNonceDb;
 
    /// Hidden constructor for singleton
@@ -20,6 +20,7 @@
 #include <os/OsServerTask.h>
 #include <utl/UtlHashMap.h>
 #include <net/SipDialog.h>
+#include <net/SipRefreshScheduler.h>
 
 // DEFINES
 // MACROS
@@ -112,7 +113,9 @@ public:
     //! Send message and keep request refreshed (i.e. subscribed or registered)
     /*! 
      *  Returns TRUE if the request was sent and the 
-     *  refresh state proceeded to REFRESH_INITIATED.
+     *  refresh state proceeded to REFRESH_INITIATED, or if the
+     *  request was queued to be sent later by the startup batch
+     *  ramp, rate limit or in-flight limit.
      *  Returns FALSE if the request was not able to
      *  be sent, the refresh state is set to REFRESH_FAILED.
      *  The caller of this method must explicitly call stopRefresh
@@ -152,6 +155,33 @@ public:
     //! Handler for SUBSCRIBE and REGISTER responses
     UtlBoolean handleMessage(OsMsg &eventMessage);
 
+    //! Limit the rate of requests sent to each destination
+    /*! Requests over the limit are queued until a token is available.
+     *  \param requestsPerSecond - zero (the default) disables the limit
+     *  \param burstSize - requests which may be sent back to back to
+     *         an idle destination
+     */
+    void setRateLimit(int requestsPerSecond, int burstSize);
+
+    //! Limit the number of requests awaiting a final response
+    /*! Zero (the default) disables the limit.
+     */
+    void setMaxRefreshesInFlight(int maxInFlight);
+
+    //! Spread refreshes randomly over the given percent of the refresh interval
+    /*! Refreshes are only moved earlier.  The default is 10 percent.
+     */
+    void setRefreshJitter(int percent);
+
+    //! Ramp initial requests at the given rate
+    /*! Use when adding many lines or subscriptions at once (e.g. at
+     *  startup).  Remains in effect until endBatchRefresh is called.
+     */
+    void startBatchRefresh(int requestsPerSecond);
+
+    //! Stop ramping initial requests
+    void endBatchRefresh();
+
 /* ============================ ACCESSORS ================================= */
 
     //! Debugging method to get an dump of all refresh states
@@ -165,6 +195,15 @@ public:
     //! Get a count of the subscriptions and registration which have been added
     int countRefreshSessions() const;
 
+    //! Get a count of the requests queued by the rate, in-flight or batch limits
+    int countDeferredRefreshes() const;
+
+    //! Get a count of the requests sent and awaiting a final response
+    int countRefreshesInFlight() const;
+
+    //! Get the total number of times a request was held back by a limit
+    int getThrottledRefreshCount() const;
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
     //! lock for single thread use
@@ -197,6 +236,15 @@ private:
     void setRefreshTimer(RefreshDialogState& state, 
                          UtlBoolean isSuccessfulReschedule);
 
+    //! Create a new timer and set it to fire in the given milliseconds
+    void startRefreshTimer(RefreshDialogState& state, int msecs);
+
+    //! Queue the request of the given state to be sent in the given milliseconds
+    void deferRefresh(RefreshDialogState& state, int msecs);
+
+    //! Release the in-flight slot held by the state, if any
+    void releaseInFlight(RefreshDialogState& state);
+
     //! Calculate the time in seconds when a refresh should occur
     /*! Assume that the register or subscribe will succeed and that
      *  we should send the refresh safely before the expiration
@@ -230,6 +278,8 @@ private:
     UtlHashMap mEventTypes; // SIP event types that we want SUBSCRIBE responses for
     UtlBoolean mReceivingRegisterResponses;
     int mDefaultExpiration;
+    SipRefreshScheduler mScheduler; // paces the sending of requests
+    int mDeferredRefreshes; // requests waiting on mScheduler
 };
 
 /* ============================ INLINE METHODS ============================ */
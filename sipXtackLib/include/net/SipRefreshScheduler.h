@@ -0,0 +1,145 @@
+//
+// Copyright (C) 2006-2019 SIPez LLC.  All rights reserved.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SipRefreshScheduler_h_
+#define _SipRefreshScheduler_h_
+
+// SYSTEM INCLUDES
+
+// APPLICATION INCLUDES
+#include <os/OsDefs.h>
+#include <os/OsTime.h>
+#include <utl/UtlHashBag.h>
+#include <utl/UtlRandom.h>
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// FORWARD DECLARATIONS
+class UtlString;
+
+// TYPEDEFS
+
+//! Pacing policy for REGISTER and SUBSCRIBE refreshes
+/*! Decides when a refresh request may go out so that many lines
+ *  refreshing at once do not flood the next hop or the transaction
+ *  layer:
+ *  \li a token bucket per destination limits the request rate,
+ *  \li a bound on the number of requests awaiting a final response,
+ *  \li random jitter which spreads refreshes that were scheduled together,
+ *  \li a startup batch mode which ramps initial requests at a fixed rate.
+ *
+ *  All limits are off by default except jitter.  This class does no
+ *  locking of its own; SipRefreshManager calls it with its lock held.
+ *  Times are passed in so that the policy can be tested without a clock.
+ */
+class SipRefreshScheduler
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+    enum
+    {
+        DEFAULT_JITTER_PERCENT = 10,
+        IN_FLIGHT_RETRY_MSECS = 200
+    };
+
+/* ============================ CREATORS ================================== */
+
+    //! Default constructor, no rate or in-flight limits
+    SipRefreshScheduler();
+
+    //! Destructor
+    virtual
+    ~SipRefreshScheduler();
+
+/* ============================ MANIPULATORS ============================== */
+
+    //! Limit the rate of requests to each destination
+    /*! \param requestsPerSecond - sustained rate, zero disables the limit
+     *  \param burstSize - number of requests which may be sent back to
+     *         back to an idle destination, at least one
+     */
+    void setRateLimit(int requestsPerSecond, int burstSize);
+
+    //! Limit the number of requests awaiting a final response, zero disables
+    void setMaxInFlight(int maxInFlight);
+
+    //! Set the spread applied to refresh intervals as a percent of the interval
+    void setJitter(int percent);
+
+    //! Ramp initial requests at the given rate until endBatch is called
+    void startBatch(int requestsPerSecond, const OsTime& now);
+
+    //! Leave startup batch mode
+    void endBatch();
+
+    //! Randomize a refresh interval
+    /*! The result lies between (100 - jitter)% of the interval and the
+     *  interval itself.  Refreshes are only ever moved earlier so that
+     *  they still happen before the subscription or registration expires.
+     */
+    int jitterInterval(int intervalMsecs);
+
+    //! Reserve the next startup slot for an initial request
+    /*! \returns milliseconds from now until the slot, zero if not in
+     *           batch mode or if the request may go now
+     */
+    int getStartupDelay(const OsTime& now);
+
+    //! Ask to send a request to the given destination
+    /*! \returns zero if the request may be sent now, in which case it
+     *           has been counted as in flight and requestDone must be
+     *           called once it is finished.  Otherwise the number of
+     *           milliseconds to wait before asking again.
+     */
+    int admit(const UtlString& destination, const OsTime& now);
+
+    //! Release a request that admit let through
+    void requestDone();
+
+/* ============================ ACCESSORS ================================= */
+
+    //! Number of admitted requests which have not been released
+    int getInFlightCount() const;
+
+    //! Total number of times admit asked a request to wait
+    int getThrottledCount() const;
+
+/* ============================ INQUIRY =================================== */
+
+    //! Is the startup batch mode on
+    UtlBoolean isBatchActive() const;
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+    //! Copy constructor NOT ALLOWED
+    SipRefreshScheduler(const SipRefreshScheduler& rSipRefreshScheduler);
+
+    //! Assignment operator NOT ALLOWED
+    SipRefreshScheduler& operator=(const SipRefreshScheduler& rhs);
+
+    int mRequestsPerSecond;
+    int mBurstSize;
+    int mMaxInFlight;
+    int mJitterPercent;
+    int mBatchRequestsPerSecond;
+    OsTime mNextBatchSlot;
+    int mInFlight;
+    int mThrottled;
+    UtlHashBag mBuckets; // token bucket for each destination
+    UtlRandom mRandom;
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+#endif  // _SipRefreshScheduler_h_
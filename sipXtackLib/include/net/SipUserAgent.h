@@ -56,6 +56,7 @@ class OsConfigDb;
 class OsQueuedEvent;
 class OsTimer;
 class SipSession;
+class SipObserverCriteria;
 class SipTcpServer;
 class SipLineMgr;
 class SipUserAgentBase;
@@ -742,6 +743,7 @@ private:
     UtlString mUserAgentHeaderProperties;
     UtlHashBag mMyHostAliases;
     UtlHashBag mMessageObservers;
+    UtlHashMap mObserverIndex; // "METHOD\nevent" -> UtlSList of observers in mMessageObservers
     UtlHashMap mExternalTransports;
     OsRWMutex mMessageLogRMutex;
     OsRWMutex mMessageLogWMutex;
@@ -792,6 +794,13 @@ private:
 
     void queueMessageToInterestedObservers(SipMessageEvent& event,
                                            const UtlString& method);
+    void queueMessageToObserver(SipMessageEvent& event,
+                                SipObserverCriteria* observer);
+    void indexMessageObserver(SipObserverCriteria* observer);
+    void unindexMessageObserver(SipObserverCriteria* observer);
+    static void getObserverIndexKey(const UtlString& method,
+                                    const UtlString& eventName,
+                                    UtlString& indexKey);
     void queueMessageToObservers(SipMessage* message,
                                  int messageType);
 
@@ -61,6 +61,8 @@
 
 // STATIC VARIABLE INITIALIZATIONS
 OsAtomicInt HttpMessage::smHttpMessageCount(0);
+OsAtomicULong HttpMessage::smSerializeCount(0L);
+OsAtomicULong HttpMessage::smBytesCacheHitCount(0L);
 
 // LOCAL MACROS
 #ifdef _VXWORKS
@@ -76,7 +78,10 @@ HttpMessage::HttpMessage(const char* messageBytes, int byteCount)
 {
    smHttpMessageCount++;
 
-   mHeaderCacheClean = FALSE;
+   mMessageVersion = 1;
+   mBytesCacheVersion = 0;
+   mpBytesCacheBody = NULL;
+   mBytesCacheBodyLength = 0;
 
    //nameValues = new UtlHashBag(100);
    body = NULL;
@@ -100,7 +105,10 @@ HttpMessage::HttpMessage(OsSocket* inSocket, int bufferSize)
 {
    smHttpMessageCount++;
 
-   mHeaderCacheClean = FALSE;
+   mMessageVersion = 1;
+   mBytesCacheVersion = 0;
+   mpBytesCacheBody = NULL;
+   mBytesCacheBodyLength = 0;
 
    //mNameValues = new UtlHashBag(100);
    body = NULL;
@@ -126,13 +134,25 @@ HttpMessage::HttpMessage(const HttpMessage& rHttpMessage)
    smHttpMessageCount++;
    //UtlString messageBytes;
    //int len;
-   mHeaderCacheClean = rHttpMessage.mHeaderCacheClean;
    mFirstHeaderLine = rHttpMessage.mFirstHeaderLine;
    body = NULL;
    if(rHttpMessage.body)
    {
       body = HttpBody::copyBody(*(rHttpMessage.body));
    }
+
+   // The copy serializes to the same bytes, so it can share the cache
+   mMessageVersion = 1;
+   mBytesCacheVersion = 0;
+   mpBytesCacheBody = NULL;
+   mBytesCacheBodyLength = 0;
+   if(rHttpMessage.isBytesCacheValid())
+   {
+      mBytesCache = rHttpMessage.mBytesCache;
+      mBytesCacheVersion = mMessageVersion;
+      mpBytesCacheBody = body;
+      mBytesCacheBodyLength = rHttpMessage.mBytesCacheBodyLength;
+   }
    //nameValues = new UtlHashBag(100);
    transportTimeStamp = rHttpMessage.transportTimeStamp;
    lastResendDuration = rHttpMessage.lastResendDuration;
@@ -173,7 +193,7 @@ HttpMessage::~HttpMessage()
    //UtlDListIterator iterator((UtlDList&)nameValues);
    NameValuePair* headerField = NULL;
 
-   mHeaderCacheClean = FALSE;
+   invalidateBytesCache();
 
    // For each name value:
    while((headerField = (NameValuePair*) mNameValues.get()))
@@ -205,7 +225,7 @@ HttpMessage::operator=(const HttpMessage& rHttpMessage)
       return *this;
 
    smHttpMessageCount--;
-   mHeaderCacheClean = rHttpMessage.mHeaderCacheClean;
+   invalidateBytesCache();
    mFirstHeaderLine = rHttpMessage.mFirstHeaderLine;
    //nameValues.destroyAll();
    // Get rid of any headers which exist in this message
@@ -227,6 +247,14 @@ HttpMessage::operator=(const HttpMessage& rHttpMessage)
       body = HttpBody::copyBody(*(rHttpMessage.body));
    }
 
+   if(rHttpMessage.isBytesCacheValid())
+   {
+      mBytesCache = rHttpMessage.mBytesCache;
+      mBytesCacheVersion = mMessageVersion;
+      mpBytesCacheBody = body;
+      mBytesCacheBodyLength = rHttpMessage.mBytesCacheBodyLength;
+   }
+
    //use copy constructor to copy values
    smHttpMessageCount++;
    //UtlString messageBytes;
@@ -282,7 +310,7 @@ HttpMessage::operator=(const HttpMessage& rHttpMessage)
 
 int HttpMessage::parseFirstLine(const char* messageBytesPtr, int byteCount)
 {
-   mHeaderCacheClean = FALSE;
+   invalidateBytesCache();
    mFirstHeaderLine = OsUtil::NULL_OS_STRING;
    int bytesConsumed = 0;
 
@@ -320,7 +348,7 @@ int HttpMessage::parseFirstLine(const char* messageBytesPtr, int byteCount)
 // the need arrises for it atomic functionality
 void HttpMessage::parseMessage(const char* messageBytes, int byteCount)
 {
-   mHeaderCacheClean = FALSE;
+   invalidateBytesCache();
 
    if(byteCount <= 0)
    {
@@ -642,7 +670,7 @@ OsStatus HttpMessage::get(Url& httpUrl,
       int iRead = readHeader(httpSocket, buffer) ;
       if (iRead > 0)
       {
-         mHeaderCacheClean = FALSE;
+         invalidateBytesCache();
          int iHeaderLength = parseFirstLine(buffer.data(), iRead) ;
          parseHeaders(&buffer.data()[iHeaderLength], iRead-iHeaderLength, mNameValues) ;
 
@@ -962,7 +990,7 @@ int HttpMessage::get(Url& httpUrl,
                 bytesRead = 0;
 
                 // Clear out the data in the previous response
-                mHeaderCacheClean = FALSE;
+                invalidateBytesCache();
                 mNameValues.destroyAll();
                     if(body)
                     {
@@ -1113,7 +1141,7 @@ int HttpMessage::read(OsSocket* inSocket, int bufferSize,
    // of the incoming HTTP message.
    //
 
-   mHeaderCacheClean = FALSE;
+   invalidateBytesCache();
    // Remember to empty the list of parsed header values, as we will use it
    // to parse the headers on the HTTP response we are going to read.
    mNameValues.destroyAll();
@@ -1802,6 +1830,18 @@ int HttpMessage::getHttpMessageCount()
     return(smHttpMessageCount);
 }
 
+void HttpMessage::getSerializationCounts(unsigned long& serializeCount,
+                                         unsigned long& cacheHitCount)
+{
+    serializeCount = smSerializeCount;
+    cacheHitCount = smBytesCacheHitCount;
+}
+
+unsigned int HttpMessage::getMessageVersion() const
+{
+    return(mMessageVersion);
+}
+
 const char* HttpMessage::getFirstHeaderLine() const
 {
         return(mFirstHeaderLine.data());
@@ -1809,7 +1849,7 @@ const char* HttpMessage::getFirstHeaderLine() const
 
 void HttpMessage::setFirstHeaderLine(const char* newHeaderLine)
 {
-    mHeaderCacheClean = FALSE;
+    invalidateBytesCache();
         if(newHeaderLine)
     {
         mFirstHeaderLine.remove(0);
@@ -2033,7 +2073,7 @@ const char* HttpMessage::getHeaderValue(int index, const char* name) const
 
 void HttpMessage::setHeaderValue(const char* name, const char* newValue, int index)
 {
-    mHeaderCacheClean = FALSE;
+    invalidateBytesCache();
         NameValuePair* headerField = getHeaderField(index, name);
 
         if(headerField)
@@ -2049,7 +2089,7 @@ void HttpMessage::setHeaderValue(const char* name, const char* newValue, int ind
 
 UtlBoolean HttpMessage::removeHeader(const char* name, int index)
 {
-   mHeaderCacheClean = FALSE;
+   invalidateBytesCache();
    UtlBoolean foundHeader = FALSE;
    UtlDListIterator iterator((UtlDList&)mNameValues);
    NameValuePair* headerFieldName = NULL;
@@ -2101,7 +2141,7 @@ UtlBoolean HttpMessage::removeHeader(const char* name, int index)
 
 void HttpMessage::addHeaderField(const char* name, const char* value)
 {
-    mHeaderCacheClean = FALSE;
+    invalidateBytesCache();
     NameValuePair* headerField =
         new NameValuePair(name ? name : "", value);
     headerField->toUpper();
@@ -2112,7 +2152,7 @@ void HttpMessage::insertHeaderField(const char* name,
                                     const char* value,
                                     int index)
 {
-    mHeaderCacheClean = FALSE;
+    invalidateBytesCache();
     NameValuePair* headerField =
         new NameValuePair(name ? name : "", value);
     headerField->toUpper();
@@ -2126,6 +2166,7 @@ const HttpBody* HttpMessage::getBody() const
 
 void HttpMessage::setBody(HttpBody* newBody)
 {
+    invalidateBytesCache();
     if(body)
     {
         delete body;
@@ -2363,6 +2404,15 @@ void HttpMessage::setLocationField(const char* locationField)
 
 void HttpMessage::getBytes(UtlString* bufferString, int* length) const
 {
+    if(isBytesCacheValid())
+    {
+        // Nothing changed since the last serialization
+        *bufferString = mBytesCache;
+        *length = mBytesCache.length();
+        smBytesCacheHitCount++;
+        return;
+    }
+
         *length = 0;
         UtlString name;
         const char* value;
@@ -2381,34 +2431,6 @@ void HttpMessage::getBytes(UtlString* bufferString, int* length) const
                 body->getBytes(&bodyBytes, &bodyLen);
     }
 
-    int oldLen = 0 ;
-    if(mHeaderCacheClean &&
-        bodyLen == (oldLen = getContentLength()))
-    {
-        // We have a clean serialized cache of the first header line
-        // and headers, use it instead of serializing it
-
-        // Check if the content length is explicitly set
-        //if(oldLen > 0 ||  // avoid getHeaderField call if content length set
-        //   getHeaderField(0, HTTP_CONTENT_LENGTH_FIELD))
-        //{
-        //    foundContentLengthHeader = TRUE;
-        //}
-
-        // dummy code to allow instrumentation and setting of break points
-        oldLen = 0;
-    }
-    else
-    {
-        // we have to serialize the headers and cache the result
-        // This cast is a bit of hack for this instrumention so that
-        // the const signature does not have to change
-        ((HttpMessage*)this)->mHeaderCacheClean = TRUE;
-
-        // dummy code to allow instrumentation and setting of break points
-        oldLen = 0;
-    }
-
         // For each name value:
         while((headerField = (NameValuePair*) iterator()))
         {
@@ -2475,6 +2497,12 @@ void HttpMessage::getBytes(UtlString* bufferString, int* length) const
         }
 
         *length = bufferString->length();
+
+        smSerializeCount++;
+        mBytesCache = *bufferString;
+        mBytesCacheVersion = mMessageVersion;
+        mpBytesCacheBody = body;
+        mBytesCacheBodyLength = body ? body->getLength() : 0;
 }
 
 void HttpMessage::getFirstHeaderLinePart(int partIndex, UtlString* part, char separator) const
@@ -3082,17 +3110,15 @@ void HttpMessage::buildMd5UserPasswordDigest(const char* user,
                                              const char* password,
                                              UtlString& userPasswordDigest)
 {
-    // Construct A1
-    UtlString a1Buffer;
-
-    if(user) a1Buffer.append(user);
-    a1Buffer.append(':');
-    if(realm) a1Buffer.append(realm);
-    a1Buffer.append(':');
-    if(password) a1Buffer.append(password);
+    // Encode A1 = user:realm:password
+    NetMd5Codec a1;
+    if(user) a1.hash(user, strlen(user));
+    a1.hash(":", 1);
+    if(realm) a1.hash(realm, strlen(realm));
+    a1.hash(":", 1);
+    if(password) a1.hash(password, strlen(password));
 
-    // Encode A1
-    NetMd5Codec::encode(a1Buffer.data(), userPasswordDigest);
+    a1.appendHashValue(userPasswordDigest);
 }
 
 /*void HttpMessage::buildMd5Digest(const char* user, const char* password,
@@ -3127,74 +3153,71 @@ void HttpMessage::buildMd5Digest(const char* userPasswordDigest,
                                  const char* bodyDigest,
                                  UtlString* responseToken)
 {
-    // Construct A1
-    UtlString encodedA1;
-    UtlString alg(algorithm ? algorithm : "");
-    if(alg.compareTo(HTTP_MD5_SESSION_ALGORITHM, UtlString::ignoreCase) == 0)
-    {
-        UtlString a1Buffer(userPasswordDigest);
-        a1Buffer.append(':');
-        if(nonce) a1Buffer.append(nonce);
-        a1Buffer.append(':');
-        if(cnonce) a1Buffer.append(cnonce);
-        NetMd5Codec::encode(a1Buffer.data(), encodedA1);
-
-    }
-    else
-    {
-        encodedA1 = userPasswordDigest;
-    }
+    // The fields are fed to the hash directly rather than being
+    // concatenated into buffers first
+    size_t nonceLength = nonce ? strlen(nonce) : 0;
+    size_t cnonceLength = cnonce ? strlen(cnonce) : 0;
+    NetMd5Codec md5;
 
-    // Construct A2
-    UtlString a2Buffer;
-    UtlString encodedA2;
-    if(method) a2Buffer.append(method);
-    a2Buffer.append(':');
-    if(uri) a2Buffer.append(uri);
+    // Construct A1
+    char encodedA1[MD5_SIZE + 1];
+    const char* a1 = userPasswordDigest;
+    if(algorithm &&
+       strcasecmp(algorithm, HTTP_MD5_SESSION_ALGORITHM) == 0)
+    {
+        md5.hash(userPasswordDigest, strlen(userPasswordDigest));
+        md5.hash(":", 1);
+        if(nonce) md5.hash(nonce, nonceLength);
+        md5.hash(":", 1);
+        if(cnonce) md5.hash(cnonce, cnonceLength);
+        md5.getEncodedHashValue(encodedA1);
+        a1 = encodedA1;
+    }
+
+    // Construct and encode A2
+    char encodedA2[MD5_SIZE + 1];
+    if(method) md5.hash(method, strlen(method));
+    md5.hash(":", 1);
+    if(uri) md5.hash(uri, strlen(uri));
     UtlString qopString(qop ? qop : "");
     UtlBoolean qopInt = FALSE;
     int qopIndex = qopString.index(HTTP_QOP_AUTH_INTEGRITY, 0, UtlString::ignoreCase);
     if(qopIndex >= 0)
     {
         qopInt = TRUE;
-        a2Buffer.append(':');
-        if(bodyDigest) a2Buffer.append(bodyDigest);
+        md5.hash(":", 1);
+        if(bodyDigest) md5.hash(bodyDigest, strlen(bodyDigest));
     }
+    md5.getEncodedHashValue(encodedA2);
 
-    // Encode A2
-    NetMd5Codec::encode(a2Buffer.data(), encodedA2);
-
-    // Construct buffer
-    UtlString buffer(encodedA1);
-    buffer.append(':');
-    if(nonce) buffer.append(nonce);
+    // Construct and encode the response
+    md5.hash(a1, strlen(a1));
+    md5.hash(":", 1);
+    if(nonce) md5.hash(nonce, nonceLength);
     qopIndex = qopString.index(HTTP_QOP_AUTH, 0, UtlString::ignoreCase);
     if(qopIndex >= 0)
     {
         char nonceCountBuffer[20];
         sprintf(nonceCountBuffer, "%.8x", nonceCount);
-        UtlString nonceCountString(nonceCountBuffer);
-        nonceCountString.toLower();
 
-        buffer.append(':');
-        buffer.append(nonceCountString);
-        buffer.append(':');
-        if(cnonce) buffer.append(cnonce);
-        buffer.append(':');
+        md5.hash(":", 1);
+        md5.hash(nonceCountBuffer, strlen(nonceCountBuffer));
+        md5.hash(":", 1);
+        if(cnonce) md5.hash(cnonce, cnonceLength);
+        md5.hash(":", 1);
         if(qopInt)
         {
-            buffer.append(HTTP_QOP_AUTH_INTEGRITY);
+            md5.hash(HTTP_QOP_AUTH_INTEGRITY, strlen(HTTP_QOP_AUTH_INTEGRITY));
         }
         else
         {
-            buffer.append(HTTP_QOP_AUTH);
+            md5.hash(HTTP_QOP_AUTH, strlen(HTTP_QOP_AUTH));
         }
     }
-    buffer.append(':');
-    buffer.append(encodedA2);
+    md5.hash(":", 1);
+    md5.hash(encodedA2, MD5_SIZE);
 
-    // Encode buffer
-    NetMd5Codec::encode(buffer.data(), *responseToken);
+    md5.appendHashValue(*responseToken);
 
 #ifdef TEST_PRINT
     osPrintf("HttpMessage::buildMd5Digest expecting authorization:\n\tuserPasswordDigest: '%s'\n\tnonce: '%s'\n\tmethod: '%s'\n\turi: '%s'\n\tresponse: '%s'\n",
@@ -3557,6 +3580,14 @@ UtlBoolean HttpMessage::isWholeMessage(const char* messageBuffer,
     return(FALSE);
 }
 
+UtlBoolean HttpMessage::isBytesCacheValid() const
+{
+    // A body swapped or resized behind our back also invalidates the cache
+    return(mBytesCacheVersion == mMessageVersion &&
+           mpBytesCacheBody == body &&
+           mBytesCacheBodyLength == (body ? body->getLength() : 0));
+}
+
 UtlBoolean HttpMessage::isFirstSend() const
 {
     return(!mFirstSent);
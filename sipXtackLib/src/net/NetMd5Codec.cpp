@@ -25,13 +25,6 @@
 typedef uint16_t UINT2;
 typedef uint32_t UINT4;
 
-/* MD5 context. */
-typedef struct {
-   UINT4 state[4];                                   /* state (ABCD) */
-   UINT4 count[2];        /* number of bits, modulo 2^64 (lsb first) */
-   unsigned char buffer[64];                         /* input buffer */
-} MD5_CTX_PT;
-
 static void MD5Init(MD5_CTX_PT *);
 static void MD5Update(MD5_CTX_PT *, unsigned char *, unsigned int);
 static void MD5Final(unsigned char [16], MD5_CTX_PT *);
@@ -43,6 +36,7 @@ static void MD5Final(unsigned char [16], MD5_CTX_PT *);
 // Constructor
 NetMd5Codec::NetMd5Codec()
 {
+   MD5Init(&mContext);
 }
 
 // Destructor
@@ -54,25 +48,52 @@ NetMd5Codec::~NetMd5Codec()
 
 void NetMd5Codec::encode(const char* text, UtlString& encodedText)
 {
+   NetMd5Codec md5;
+   md5.hash(text, strlen(text));
+   md5.appendHashValue(encodedText);
+}
 
-   // This stuff should be packaged into a real class where the
-   // init and update happens in the constructor, and the final is a method
-   MD5_CTX_PT context;
-   unsigned char digest[16];
-   unsigned int len = strlen (text);
-   unsigned int i;
-   char szTmp[MD5_SIZE];
+void NetMd5Codec::hash(const char* data, size_t length)
+{
+   MD5Update(&mContext, (unsigned char *)data, length);
+}
 
-   memset(digest,0,sizeof(digest));
-   MD5Init (&context);
-   MD5Update (&context, (unsigned char *)text, len);
-   MD5Final (digest, &context);
+void NetMd5Codec::hash(const UtlString& data)
+{
+   MD5Update(&mContext, (unsigned char *)data.data(), data.length());
+}
+
+void NetMd5Codec::getHashValue(unsigned char digest[MD5_BIN_SIZE])
+{
+   MD5Final(digest, &mContext);
+   MD5Init(&mContext);
+}
+
+void NetMd5Codec::getEncodedHashValue(char encodedText[MD5_SIZE + 1])
+{
+   unsigned char digest[MD5_BIN_SIZE];
+   getHashValue(digest);
+   encodeHex(digest, encodedText);
+}
+
+void NetMd5Codec::appendHashValue(UtlString& encodedText)
+{
+   char szTmp[MD5_SIZE + 1];
+   getEncodedHashValue(szTmp);
+   encodedText.append(szTmp, MD5_SIZE);
+}
+
+void NetMd5Codec::encodeHex(const unsigned char digest[MD5_BIN_SIZE],
+                            char encodedText[MD5_SIZE + 1])
+{
+   static const char hexDigits[] = "0123456789abcdef";
 
-   for (i = 0; i < 16; i++)
+   for (unsigned int i = 0; i < MD5_BIN_SIZE; i++)
    {
-      sprintf(szTmp, "%02x", digest[i]);
-      encodedText.append(szTmp);
+      encodedText[2*i]     = hexDigits[digest[i] >> 4];
+      encodedText[2*i + 1] = hexDigits[digest[i] & 0x0f];
    }
+   encodedText[MD5_SIZE] = '\0';
 }
 
 /* ============================ ACCESSORS ================================= */
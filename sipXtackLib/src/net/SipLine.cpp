@@ -311,9 +311,7 @@ UtlBoolean SipLine::getCredentials(const UtlString& type /*[in]*/,
                              UtlString* MD5_token /*[out]*/)
 {
    UtlBoolean credentialsFound = FALSE;
-   UtlString matchRealm(realm);
    UtlString emptyRealm(NULL);
-   UtlString userPassword;
    *MD5_token = "";
 
 #ifdef TEST_PRINT
@@ -321,17 +319,17 @@ UtlBoolean SipLine::getCredentials(const UtlString& type /*[in]*/,
                  mCredentials.entries(), mIdentity.toString().data());
 #endif
 
-   SipLineCredentials* credential = (SipLineCredentials*) mCredentials.find(&matchRealm);
+   SipLineCredentials* credential = (SipLineCredentials*) mCredentials.find(&realm);
    if (credential)
    {
 #ifdef TEST_PRINT
-      OsSysLog::add(FAC_AUTH, PRI_DEBUG, "SipLine::getCredentials found credentials for realm: <%s>", matchRealm.data());
+      OsSysLog::add(FAC_AUTH, PRI_DEBUG, "SipLine::getCredentials found credentials for realm: <%s>", realm.data());
 #endif
+      // The digest for the credential's own realm is computed once
       credential->getUserId(userID);
-      credential->getPasswordToken(&userPassword);
+      credential->getPasswordDigest(MD5_token);
       credentialsFound = TRUE;
       credential = NULL;
-      HttpMessage::buildMd5UserPasswordDigest(userID->data(), matchRealm.data(), userPassword.data(), *MD5_token);
    }
    else
    {
@@ -341,6 +339,8 @@ UtlBoolean SipLine::getCredentials(const UtlString& type /*[in]*/,
 #ifdef TEST_PRINT
           OsSysLog::add(FAC_AUTH, PRI_DEBUG, "SipLine::getCredentials found credentials for realm: <%s>", emptyRealm.data());
 #endif
+          // Wildcard credentials are hashed with the challenge realm
+          UtlString userPassword;
           credential->getUserId(userID);
           credential->getPasswordToken(&userPassword);
           credentialsFound = TRUE;
@@ -362,7 +362,6 @@ UtlBoolean SipLine::getDuplicateCredentials(const UtlString& type /*[in]*/,
                                             const UtlString& realm /*[in]*/)
 {
    UtlBoolean credentialsFound = FALSE;
-   UtlString matchRealm(realm);
    UtlString emptyRealm(NULL);
 
    if (realm.length() == 0)
@@ -376,7 +375,7 @@ UtlBoolean SipLine::getDuplicateCredentials(const UtlString& type /*[in]*/,
    }
    else
    {
-      SipLineCredentials* credential = (SipLineCredentials*) mCredentials.find(&matchRealm);
+      SipLineCredentials* credential = (SipLineCredentials*) mCredentials.find(&realm);
       if (credential)
       {
          credentialsFound = TRUE;
@@ -496,10 +495,8 @@ UtlBoolean SipLine::getAllCredentials( int MaxEnteries/*[in]*/ ,
 
 
 
-UtlBoolean SipLine::IsDuplicateRealm(const UtlString realm, const UtlString scheme)
+UtlBoolean SipLine::IsDuplicateRealm(const UtlString& realm, const UtlString& scheme)
 {
-   UtlString userID;
-   UtlString passToken;
    if (getDuplicateCredentials(scheme, realm))
       return TRUE;
    else
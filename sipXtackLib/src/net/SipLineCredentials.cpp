@@ -30,6 +30,11 @@ SipLineCredentials::SipLineCredentials( const UtlString realm,
         mPasswordToken = passwordToken;
         mUserId = userId;
         mRealm = realm;
+
+        // Computed here rather than on every authentication retry
+        HttpMessage::buildMd5UserPasswordDigest(mUserId.data(), mRealm.data(),
+                                                mPasswordToken.data(),
+                                                mPasswordDigest);
 }
 
 SipLineCredentials::~SipLineCredentials()
@@ -60,3 +65,9 @@ void SipLineCredentials::getType(UtlString* type)
         type->remove(0);
         type->append(mType);
 }
+
+void SipLineCredentials::getPasswordDigest(UtlString* passwordDigest)
+{
+        passwordDigest->remove(0);
+        passwordDigest->append(mPasswordDigest);
+}
@@ -11,15 +11,21 @@
 
 #include "net/SipLineList.h"
 #include "os/OsSysLog.h"
+#include "utl/UtlHashMapIterator.h"
+#include "utl/UtlSListIterator.h"
+#include "utl/UtlVoidPtr.h"
 //#define TEST_PRINT
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
 SipLineList::SipLineList()
+   : mIndexLock(OsRWMutex::Q_FIFO)
 {}
 
 SipLineList::~SipLineList()
 {    
+    OsWriteLock lock(mIndexLock);
+    clearIndex();
     while (SipLine* pLine = (SipLine*) m_LineList.pop()) 
     {
         delete pLine ;
@@ -29,7 +35,9 @@ SipLineList::~SipLineList()
 void
 SipLineList::add(SipLine *newLine)
 {
+   OsWriteLock lock(mIndexLock);
         m_LineList.push(newLine);
+   indexLine(newLine);
 }
 
 UtlBoolean
@@ -43,22 +51,31 @@ SipLineList::remove(SipLine *line)
 UtlBoolean
 SipLineList::remove(const Url& lineIdentityUrl)
 {
-   SipLine* nextline = NULL;
+   OsWriteLock lock(mIndexLock);
+   SipLine* line = NULL;
 
-   int iteratorHandle = m_LineList.getIteratorHandle();
-        while(NULL != (nextline = (SipLine*) m_LineList.next(iteratorHandle)))
-        {
-      // compare the line identities
-      Url nextLineUrl = nextline->getIdentity();
-      if (lineIdentityUrl.isUserHostPortEqual(nextLineUrl))
+   UtlString identityKey;
+   getIdentityKey(lineIdentityUrl, identityKey);
+   UtlSList* lines = getIndexed(mIdentityIndex, identityKey);
+   if (lines)
+   {
+      line = (SipLine*) ((UtlVoidPtr*) lines->first())->getValue();
+      unindexLine(line);
+
+      SipLine* nextline = NULL;
+      int iteratorHandle = m_LineList.getIteratorHandle();
+      while(NULL != (nextline = (SipLine*) m_LineList.next(iteratorHandle)))
       {
-         m_LineList.remove(iteratorHandle);
-         break;
+         if (nextline == line)
+         {
+            m_LineList.remove(iteratorHandle);
+            break;
+         }
       }
+      m_LineList.releaseIteratorHandle(iteratorHandle);
    }
-   m_LineList.releaseIteratorHandle(iteratorHandle);
 
-        return( nextline != NULL );
+        return( line != NULL );
 }
 
 UtlBoolean
@@ -72,76 +89,45 @@ SipLineList::isDuplicate( SipLine *line )
 UtlBoolean
 SipLineList::isDuplicate( const Url& lineIdentityUrl )
 {
-   SipLine* nextline = NULL;
-   UtlBoolean isDuplicate = FALSE;
+   OsReadLock lock(mIndexLock);
+   UtlString identityKey;
+   getIdentityKey(lineIdentityUrl, identityKey);
 
-   int iteratorHandle = m_LineList.getIteratorHandle();
-   while(NULL != (nextline = (SipLine*) m_LineList.next(iteratorHandle)))
-   {
-      // compare the line identities
-      Url nextLineUrl = nextline->getIdentity();
-      if (lineIdentityUrl.isUserHostPortEqual(nextLineUrl))
-      {
-         isDuplicate = TRUE;
-         break;
-      }
-   }
-   m_LineList.releaseIteratorHandle(iteratorHandle);
-
-        return isDuplicate;
+        return getIndexed(mIdentityIndex, identityKey) != NULL;
 }
 
 SipLine*
 SipLineList::getLine( const Url& lineIdentityUrl )
 {
-   SipLine* nextline = NULL;
+   OsReadLock lock(mIndexLock);
+   SipLine* line = NULL;
+   UtlString identityKey;
+   getIdentityKey(lineIdentityUrl, identityKey);
 
-   int iteratorHandle = m_LineList.getIteratorHandle();
-        while(NULL != (nextline = (SipLine*) m_LineList.next(iteratorHandle)))
+   UtlSList* lines = getIndexed(mIdentityIndex, identityKey);
+   if (lines)
    {
-      // compare the line identities
-      Url nextLineUrl = nextline->getIdentity();
-      if (lineIdentityUrl.isUserHostPortEqual(nextLineUrl))
-      {
-         break ;
-      }
+      line = (SipLine*) ((UtlVoidPtr*) lines->first())->getValue();
    }
 
-   m_LineList.releaseIteratorHandle(iteratorHandle);
-
-        return nextline;
+        return line;
 }
 
 SipLine*
 SipLineList::getLine(const UtlString& lineId)
 {
-        SipLine* nextline = NULL;
+        SipLine* line = NULL;
 
     if ( !lineId.isNull() )
     {
-            int iteratorHandle = m_LineList.getIteratorHandle();
-            while(NULL != (nextline = (SipLine*) m_LineList.next(iteratorHandle)))
+        OsReadLock lock(mIndexLock);
+        UtlSList* lines = getIndexed(mLineIdIndex, lineId);
+        if (lines)
         {
-            // compare the line identities
-            UtlString nextLineId = nextline->getLineId();
-            if (!nextLineId.isNull())
-            {
-#ifdef TEST_PRINT
-                osPrintf( "SipLineList::getLine Comparing %s to %s \n",
-                          lineId.data(), nextLineId.data() );
-#endif
-                        if( lineId == nextLineId )
-                {
-#ifdef TEST_PRINT
-                    osPrintf("SipLineList::getLine TRUE\n");
-#endif
-                                break;
-                }
-            }
+            line = (SipLine*) ((UtlVoidPtr*) lines->first())->getValue();
         }
-            m_LineList.releaseIteratorHandle(iteratorHandle);
     }
-        return nextline;
+        return line;
 }
 
 SipLine*
@@ -149,40 +135,18 @@ SipLineList::getLine (
     const UtlString& userId,
     int& numOfMatches )
 {
-        SipLine* nextline = NULL;
     SipLine* firstMatchedLine = NULL;
-    UtlString nextUserId;
     numOfMatches = 0;
 
     if (!userId.isNull())
     {
-        int iteratorHandle = m_LineList.getIteratorHandle();
-            while(NULL != (nextline = (SipLine*) m_LineList.next(iteratorHandle)))
-            {
-            nextUserId.remove(0);
-            Url identity = nextline->getIdentity();
-            identity.getUserId( nextUserId );
-
-            if (!nextUserId.isNull())
-            {
-#ifdef TEST_PRINT
-                osPrintf( "SipLineList::getLine Comparing %s to %s \n",
-                          nextUserId.data(), userId.data() );
-#endif
-                        if( nextUserId.compareTo( userId ) == 0 )
-                        {
-#ifdef TEST_PRINT
-                    osPrintf("SipLineList::getLine TRUE\n");
-#endif
-                    if( numOfMatches == 0)
-                    {
-                        firstMatchedLine = nextline;
-                    }
-                    numOfMatches ++;
-                }
-            }
-            }
-        m_LineList.releaseIteratorHandle(iteratorHandle);
+        OsReadLock lock(mIndexLock);
+        UtlSList* lines = getIndexed(mUserIdIndex, userId);
+        if (lines)
+        {
+            firstMatchedLine = (SipLine*) ((UtlVoidPtr*) lines->first())->getValue();
+            numOfMatches = lines->entries();
+        }
     }
         return firstMatchedLine;
 }
@@ -295,85 +259,91 @@ SipLine* SipLineList::findLine(const char* lineId,
                                const char* userId,
                                const Url& defaultLine)
 {
-   SipLine* pLineMatchingLineID  = NULL ;
-   SipLine* pLineMatchingUrl     = NULL ;
-   SipLine* pLineMatchingUser    = NULL ;
-   SipLine* pLineMatchingDefault = NULL ;
-
-        int iteratorHandle = m_LineList.getIteratorHandle();
-        SipLine* nextLine = NULL;
-        while ((nextLine = (SipLine*) m_LineList.next(iteratorHandle))!= NULL)
-        {
-      // If the realm doesn't match, simply skip it
-      if ((realm != NULL) && strlen(realm)
-            && (!nextLine->IsDuplicateRealm(realm)))
-      {
-         continue ;
-      }
-
-      //
-      // Priority 1: Check LineId
-      //
-      if (lineId != NULL)
+   OsReadLock lock(mIndexLock);
+   UtlSList* lines;
+   UtlVoidPtr* entry;
+
+   // If the realm doesn't match, simply skip the line
+   UtlBoolean anyRealm = (realm == NULL) || (strlen(realm) == 0);
+   UtlString matchRealm(anyRealm ? NULL : realm);
+
+   //
+   // Priority 1: Check LineId
+   //
+   if (lineId != NULL)
+   {
+      UtlString lineIdKey(lineId);
+      if ((lines = getIndexed(mLineIdIndex, lineIdKey)))
       {
-         if (nextLine->getLineId().compareTo(lineId) == 0)
+         UtlSListIterator iterator(*lines);
+         while ((entry = (UtlVoidPtr*) iterator()))
          {
-            // We have match for the given lineId
-            pLineMatchingLineID = nextLine ;
-            break ;
+            SipLine* line = (SipLine*) entry->getValue();
+            if (anyRealm || line->IsDuplicateRealm(matchRealm))
+            {
+               return line;
+            }
          }
       }
+   }
 
-      Url nextLineIdentity = nextLine->getIdentity();
-
-      //
-      // Priority 2: check ToFromUrl
-      //
-      if (pLineMatchingUrl == NULL)
+   //
+   // Priority 2: check ToFromUrl
+   //
+   UtlString identityKey;
+   getIdentityKey(toFromUrl, identityKey);
+   if ((lines = getIndexed(mIdentityIndex, identityKey)))
+   {
+      UtlSListIterator iterator(*lines);
+      while ((entry = (UtlVoidPtr*) iterator()))
       {
-         if (nextLineIdentity.isUserHostPortEqual(toFromUrl))
+         SipLine* line = (SipLine*) entry->getValue();
+         if (anyRealm || line->IsDuplicateRealm(matchRealm))
          {
-            pLineMatchingUrl = nextLine ;
-            // Continue searching, because we may find a better match
+            return line;
          }
       }
+   }
 
-      //
-      // Priority 3: Matches user & realm
-      //
-      UtlString user = nextLine->getUser() ;
-      if ((pLineMatchingUser == NULL) && (userId != NULL))
+   //
+   // Priority 3: Matches user & realm (should be case sensitive)
+   //
+   if (userId != NULL)
+   {
+      UtlString userKey(userId);
+      if ((lines = getIndexed(mUserIndex, userKey)))
       {
-         if (user.compareTo(userId) == 0)    // should be case sensitive
+         UtlSListIterator iterator(*lines);
+         while ((entry = (UtlVoidPtr*) iterator()))
          {
-            pLineMatchingUser = nextLine ;
-            // Continue searching, because we may find a better match
+            SipLine* line = (SipLine*) entry->getValue();
+            if (anyRealm || line->IsDuplicateRealm(matchRealm))
+            {
+               return line;
+            }
          }
       }
+   }
 
-      //
-      // Priority 4: Check for default line
-      //
-      if (nextLineIdentity.isUserHostPortEqual(defaultLine))
+   //
+   // Priority 4: Check for default line, the last one added wins
+   //
+   SipLine* pLineMatchingDefault = NULL ;
+   getIdentityKey(defaultLine, identityKey);
+   if ((lines = getIndexed(mIdentityIndex, identityKey)))
+   {
+      UtlSListIterator iterator(*lines);
+      while ((entry = (UtlVoidPtr*) iterator()))
       {
-         pLineMatchingDefault = nextLine ;
-         // Continue searching, because we may find a better match
+         SipLine* line = (SipLine*) entry->getValue();
+         if (anyRealm || line->IsDuplicateRealm(matchRealm))
+         {
+            pLineMatchingDefault = line;
+         }
       }
    }
-   m_LineList.releaseIteratorHandle(iteratorHandle) ;
-
-   // This is ugly, but needed for the desired effect
-   if (pLineMatchingLineID)
-      return pLineMatchingLineID ;
-   else if (pLineMatchingUrl)
-      return pLineMatchingUrl ;
-   else if (pLineMatchingUser)
-      return pLineMatchingUser ;
-   else if (pLineMatchingDefault)
-      return pLineMatchingDefault ;
-   else
-      return NULL ;
-   
+
+   return pLineMatchingDefault ;
 }
 
 void SipLineList::dumpLines()
@@ -390,3 +360,112 @@ void SipLineList::dumpLines()
    }
    m_LineList.releaseIteratorHandle(iteratorHandle);
 }
+
+void SipLineList::updateIndex()
+{
+   OsWriteLock lock(mIndexLock);
+   clearIndex();
+
+   SipLine* nextline = NULL;
+   int iteratorHandle = m_LineList.getIteratorHandle();
+   while(NULL != (nextline = (SipLine*) m_LineList.next(iteratorHandle)))
+   {
+      indexLine(nextline);
+   }
+   m_LineList.releaseIteratorHandle(iteratorHandle);
+}
+
+// Assumes the write lock on mIndexLock is held
+void SipLineList::indexLine(SipLine* line)
+{
+   UtlString key;
+
+   addToIndex(mLineIdIndex, line->getLineId(), line);
+
+   getIdentityKey(line->getIdentity(), key);
+   addToIndex(mIdentityIndex, key, line);
+
+   line->getIdentity().getUserId(key);
+   addToIndex(mUserIdIndex, key, line);
+
+   addToIndex(mUserIndex, line->getUser(), line);
+}
+
+// Assumes the write lock on mIndexLock is held
+void SipLineList::unindexLine(SipLine* line)
+{
+   UtlString key;
+
+   removeFromIndex(mLineIdIndex, line->getLineId(), line);
+
+   getIdentityKey(line->getIdentity(), key);
+   removeFromIndex(mIdentityIndex, key, line);
+
+   line->getIdentity().getUserId(key);
+   removeFromIndex(mUserIdIndex, key, line);
+
+   removeFromIndex(mUserIndex, line->getUser(), line);
+}
+
+void SipLineList::clearIndex()
+{
+   clearIndex(mLineIdIndex);
+   clearIndex(mIdentityIndex);
+   clearIndex(mUserIdIndex);
+   clearIndex(mUserIndex);
+}
+
+void SipLineList::addToIndex(UtlHashMap& index,
+                             const UtlString& key,
+                             SipLine* line)
+{
+   UtlSList* lines = (UtlSList*) index.findValue(&key);
+   if (lines == NULL)
+   {
+      lines = new UtlSList();
+      index.insertKeyAndValue(new UtlString(key), lines);
+   }
+   lines->append(new UtlVoidPtr(line));
+}
+
+void SipLineList::removeFromIndex(UtlHashMap& index,
+                                  const UtlString& key,
+                                  SipLine* line)
+{
+   UtlSList* lines = (UtlSList*) index.findValue(&key);
+   if (lines)
+   {
+      UtlVoidPtr target(line);
+      UtlContainable* entry = lines->remove(&target);
+      delete entry;
+
+      if (lines->isEmpty())
+      {
+         UtlContainable* value = NULL;
+         UtlContainable* indexKey = index.removeKeyAndValue(&key, value);
+         delete indexKey;
+         delete value;
+      }
+   }
+}
+
+UtlSList* SipLineList::getIndexed(UtlHashMap& index, const UtlString& key)
+{
+   return (UtlSList*) index.findValue(&key);
+}
+
+void SipLineList::clearIndex(UtlHashMap& index)
+{
+   UtlHashMapIterator iterator(index);
+   while (iterator())
+   {
+      ((UtlSList*) iterator.value())->destroyAll();
+   }
+   index.destroyAll();
+}
+
+void SipLineList::getIdentityKey(const Url& identity, UtlString& key)
+{
+   // Same user, host (ignoring case) and port as Url::isUserHostPortEqual
+   identity.getIdentity(key);
+}
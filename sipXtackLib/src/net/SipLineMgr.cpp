@@ -1385,6 +1385,7 @@ void SipLineMgr::setUserForLine(const Url& identity, const UtlString User)
     }
     line->setUser(User);
     line = NULL;
+    sLineList.updateIndex();
 }
 
 void SipLineMgr::setUserEnteredUrlForLine(const Url& identity, UtlString sipUrl)
@@ -1398,6 +1399,7 @@ void SipLineMgr::setUserEnteredUrlForLine(const Url& identity, UtlString sipUrl)
     }
     line->setIdentityAndUrl(identity, Url(sipUrl));
     line = NULL;
+    sLineList.updateIndex();
 }
 
 UtlBoolean
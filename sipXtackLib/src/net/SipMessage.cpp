@@ -205,7 +205,7 @@ void SipMessage::replaceShortFieldNames()
       if(getLongName(nvPair->data(), &longName))
       {
          // There is a long form for this name, so replace it.
-         mHeaderCacheClean = FALSE;
+         invalidateBytesCache();
          NameValuePair* modified;
 
          /*
@@ -232,7 +232,7 @@ void SipMessage::replaceLongFieldNames()
    {
       if(getShortName(nvPair->data(), &shortName))
       {
-         mHeaderCacheClean = FALSE;
+         invalidateBytesCache();
          nvPair->remove(0);
          nvPair->append(shortName.data());
       }
@@ -2121,7 +2121,7 @@ void SipMessage::addVia(const char* domainName,
 
 void SipMessage::addViaField(const char* viaField, UtlBoolean afterOtherVias)
 {
-    mHeaderCacheClean = FALSE;
+    invalidateBytesCache();
 
    NameValuePair* nv = new NameValuePair(SIP_VIA_FIELD, viaField);
     // Look for other via fields
@@ -2146,7 +2146,7 @@ void SipMessage::addViaField(const char* viaField, UtlBoolean afterOtherVias)
 #endif
     }
 
-    mHeaderCacheClean = FALSE;
+    invalidateBytesCache();
 
     if(fieldIndex == UTL_NOT_FOUND || !afterOtherVias)
     {
@@ -3098,7 +3098,7 @@ UtlBoolean SipMessage::removeLastVia()
    NameValuePair* nv = (NameValuePair*) mNameValues.find(&viaHeaderField);
    if(nv)
    {
-        mHeaderCacheClean = FALSE;
+        invalidateBytesCache();
       mNameValues.destroy(nv);
       nv = NULL;
       fieldFound = TRUE;
@@ -3717,7 +3717,7 @@ void SipMessage::addRecordRouteUri(const char* recordRouteUri)
         new NameValuePair(SIP_RECORD_ROUTE_FIELD,
         recordRouteUriString.data());
 
-    mHeaderCacheClean = FALSE;
+    invalidateBytesCache();
    mNameValues.insertAt(0, headerField);
 }
 
@@ -4480,7 +4480,7 @@ void SipMessage::addDiversionField(const char* diversionField, UtlBoolean afterO
 {
     if(NULL != diversionField)
     {
-       mHeaderCacheClean = FALSE;
+       invalidateBytesCache();
 
        NameValuePair* nv = new NameValuePair(SIP_DIVERSION_FIELD, diversionField);
        // Look for other diversion fields
@@ -4500,7 +4500,7 @@ void SipMessage::addDiversionField(const char* diversionField, UtlBoolean afterO
     }
 #  endif
 
-    mHeaderCacheClean = FALSE;
+    invalidateBytesCache();
 
     if(fieldIndex == UTL_NOT_FOUND || afterOtherDiversions)
     {
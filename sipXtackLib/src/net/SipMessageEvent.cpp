@@ -13,12 +13,32 @@
 
 // APPLICATION INCLUDES
 #include <net/SipMessageEvent.h>
+#include <os/OsAtomics.h>
 
 // EXTERNAL FUNCTIONS
 // EXTERNAL VARIABLES
 // CONSTANTS
 // STATIC VARIABLE INITIALIZATIONS
 
+// Reference counted SipMessage shared by copies of a SipMessageEvent
+class SipMessageEventShare
+{
+public:
+   SipMessageEventShare(SipMessage* message)
+   : mpMessage(message)
+   , mRefCount(1)
+   {
+   }
+
+   ~SipMessageEventShare()
+   {
+      delete mpMessage;
+   }
+
+   SipMessage* mpMessage;
+   OsAtomicInt mRefCount;
+};
+
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
 
 /* ============================ CREATORS ================================== */
@@ -28,30 +48,31 @@ SipMessageEvent::SipMessageEvent(SipMessage* message, int status) :
 OsMsg(OsMsg::PHONE_APP, SipMessage::NET_SIP_MESSAGE)
 {
    messageStatus = status;
-   sipMessage = message;
+   mpShare = message ? new SipMessageEventShare(message) : NULL;
+}
+
+SipMessageEvent::SipMessageEvent(SipMessageEventShare* share, int status) :
+OsMsg(OsMsg::PHONE_APP, SipMessage::NET_SIP_MESSAGE)
+{
+   messageStatus = status;
+   mpShare = share;
+   if(mpShare)
+   {
+      mpShare->mRefCount++;
+   }
 }
 
 // Destructor
 SipMessageEvent::~SipMessageEvent()
 {
-        if(sipMessage)
-        {
-                delete sipMessage;
-                sipMessage = NULL;
-        }
+   releaseShare();
 }
 
 OsMsg* SipMessageEvent::createCopy() const
 {
-        // Ineffient but easy coding way to copy message
-        SipMessage* sipMsg = NULL;
-
-        if(sipMessage)
-        {
-                sipMsg = new SipMessage(*sipMessage);
-        }
-
-        return(new SipMessageEvent(sipMsg, messageStatus));
+   // The message is read only while shared, so the copy just takes
+   // another reference to it
+   return(new SipMessageEvent(mpShare, messageStatus));
 }
 /* ============================ MANIPULATORS ============================== */
 
@@ -63,26 +84,51 @@ SipMessageEvent::operator=(const SipMessageEvent& rhs)
       return *this;
 
    OsMsg::operator=(rhs);
-        messageStatus = rhs.messageStatus;
-        if(sipMessage)
-        {
-                delete sipMessage;
-                sipMessage = NULL;
-        }
-
-        if(rhs.sipMessage)
-        {
-                sipMessage = new SipMessage(*(rhs.sipMessage));
-        }
+   messageStatus = rhs.messageStatus;
+
+   if(rhs.mpShare)
+   {
+      rhs.mpShare->mRefCount++;
+   }
+   releaseShare();
+   mpShare = rhs.mpShare;
 
    return *this;
 }
 
+SipMessage* SipMessageEvent::getMessageForWrite()
+{
+   if(mpShare && isMessageShared())
+   {
+      // Copy on write: other holders keep the original
+      SipMessageEventShare* privateShare =
+         new SipMessageEventShare(new SipMessage(*(mpShare->mpMessage)));
+      releaseShare();
+      mpShare = privateShare;
+   }
+
+   return(mpShare ? mpShare->mpMessage : NULL);
+}
+
+OsStatus SipMessageEvent::postToObserver(OsMsgQ& observerQueue, void* observerData)
+{
+   const SipMessage* message = getMessage();
+   if(message == NULL ||
+      message->getResponseListenerData() == observerData)
+   {
+      return(observerQueue.send(*this));
+   }
+
+   SipMessageEvent observerEvent(new SipMessage(*message), messageStatus);
+   observerEvent.getMessageForWrite()->setResponseListenerData(observerData);
+   return(observerQueue.send(observerEvent));
+}
+
 /* ============================ ACCESSORS ================================= */
 
 const SipMessage* SipMessageEvent::getMessage()
 {
-        return(sipMessage);
+   return(mpShare ? mpShare->mpMessage : NULL);
 }
 
 void SipMessageEvent::setMessageStatus(int status)
@@ -97,8 +143,25 @@ int SipMessageEvent::getMessageStatus() const
 
 /* ============================ INQUIRY =================================== */
 
+UtlBoolean SipMessageEvent::isMessageShared() const
+{
+   return(mpShare && mpShare->mRefCount > 1);
+}
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 
+void SipMessageEvent::releaseShare()
+{
+   if(mpShare)
+   {
+      if(--(mpShare->mRefCount) == 0)
+      {
+         delete mpShare;
+      }
+      mpShare = NULL;
+   }
+}
+
 /* ============================ FUNCTIONS ================================= */
@@ -10,6 +10,8 @@
 
 
 // SYSTEM INCLUDES
+#include <stdlib.h>
+#include <string.h>
 
 // APPLICATION INCLUDES
 #include <net/SipNonceDb.h>
@@ -17,7 +19,6 @@
 #include <os/OsTime.h>
 #include <os/OsSysLog.h>
 #include <net/NetMd5Codec.h>
-#include "os/OsLock.h"
 
 // EXTERNAL FUNCTIONS
 // EXTERNAL VARIABLES
@@ -26,6 +27,9 @@
 // :TBD: replace this with a cluster-specific secret
 #define NONCE_SIGNATURE_INNER_SECRET "66287423e9e289fc9d78a3bd04475b06"
 
+// HMAC block size of MD5
+#define HMAC_MD5_BLOCK_SIZE 64
+
 // STATIC VARIABLE INITIALIZATIONS
 
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
@@ -35,8 +39,25 @@
 // Constructor
 SipNonceDb::SipNonceDb()
 {
-   mNonceSignatureSecret = NONCE_SIGNATURE_INNER_SECRET;
    // :TBD: append some configuration-specific value here
+   const char* secret = NONCE_SIGNATURE_INNER_SECRET;
+   size_t secretLength = strlen(secret);
+
+   // The key is shorter than a block, so it is just zero padded.
+   // The pads are hashed once here; each signature copies the state.
+   unsigned char innerPad[HMAC_MD5_BLOCK_SIZE];
+   unsigned char outerPad[HMAC_MD5_BLOCK_SIZE];
+   memset(innerPad, 0, sizeof(innerPad));
+   memcpy(innerPad, secret, secretLength);
+   memcpy(outerPad, innerPad, sizeof(outerPad));
+   for (int i = 0; i < HMAC_MD5_BLOCK_SIZE; i++)
+   {
+      innerPad[i] ^= 0x36;
+      outerPad[i] ^= 0x5c;
+   }
+
+   mInnerPadHash.hash((const char*) innerPad, sizeof(innerPad));
+   mOuterPadHash.hash((const char*) outerPad, sizeof(outerPad));
 }
 
 // Copy constructor
@@ -77,11 +98,15 @@ SipNonceDb::operator=(const SipNonceDb& rhs)
 // We accomplish this by constructing the nonce value as:
 //  <nonce>       := <signature><timestamp>
 //  <timestamp>   := (decimal seconds since the epoch)
-//  <signature>   := H(<timestamp><call-params><secret><realm>)
+//  <signature>   := H(<secret>, <timestamp><call-params><realm>)
 //  <call-params> := <callId><fromTag>
 //  <secret>      := NONCE_SIGNATURE_INNER_SECRET
 //
-//  H(x) is the hexadecimal encoding of MD5(x)
+//  H(k, x) is the hexadecimal encoding of HMAC-MD5 (RFC 2104) of x
+//  keyed with k
+//
+// Since everything needed to validate a nonce is in the nonce
+// itself, no record of issued nonces is kept.
 //
 // Using the call parameters incorporates them into the
 // integrity protection of the authentication response,
@@ -105,12 +130,14 @@ void SipNonceDb::createNewNonce(const UtlString& callId, //input
 {
    long now = OsDateTime::getSecsSinceEpoch();
    char dateString[20];
-   UtlString nonceSignature;
+   char signature[MD5_SIZE + 1];
 
    // create the timestamp, which will be in the clear
-   sprintf(dateString, "%ld", now);
-   nonce = SipNonceDb::nonceSignature(callId,fromTag,uri,realm,dateString);
-   nonce.append(dateString);
+   int dateLength = sprintf(dateString, "%ld", now);
+   nonceSignature(callId, fromTag, realm, dateString, dateLength, signature);
+   nonce.remove(0);
+   nonce.append(signature, MD5_SIZE);
+   nonce.append(dateString, dateLength);
 }
 
 void SipNonceDb::removeOldNonces(long oldTime)
@@ -126,20 +153,30 @@ UtlBoolean SipNonceDb::isNonceValid(const UtlString& nonce,
                                     const UtlString& fromTag,
                                     const UtlString& uri, //:TBD: no longer used
                                     const UtlString& realm,
-                                    const long expiredTime)
+                                    const long expiredTime) const
 {
    UtlBoolean valid = FALSE;
 
    if (nonce.length() > MD5_SIZE)
    {
-      UtlString timestamp = nonce(MD5_SIZE,nonce.length()-MD5_SIZE);
-      UtlString rcvdSignature = nonce(0,MD5_SIZE);
-      if (0 == rcvdSignature.compareTo(nonceSignature(callId, fromTag,
-                                                      uri, realm,
-                                                      timestamp)))
+      // Check the signature in place, without splitting the nonce
+      const char* timestamp = nonce.data() + MD5_SIZE;
+      char signature[MD5_SIZE + 1];
+      nonceSignature(callId, fromTag, realm,
+                     timestamp, nonce.length() - MD5_SIZE, signature);
+
+      // Compare every character so the time taken does not reveal
+      // how much of a forged signature was right
+      unsigned char difference = 0;
+      for (size_t i = 0; i < MD5_SIZE; i++)
+      {
+         difference |= nonce.data()[i] ^ signature[i];
+      }
+
+      if (0 == difference)
       {
          // check for expiration
-         int nonceCreated = atoi(timestamp.data());
+         long nonceCreated = atol(timestamp);
          long now = OsDateTime::getSecsSinceEpoch();
 
          if ( nonceCreated+expiredTime >= now )
@@ -149,7 +186,7 @@ UtlBoolean SipNonceDb::isNonceValid(const UtlString& nonce,
          else
          {
             OsSysLog::add(FAC_SIP,PRI_INFO,
-                          "SipNonceDB::isNonceValid expired nonce: created %d+%ld < %ld"
+                          "SipNonceDB::isNonceValid expired nonce: created %ld+%ld < %ld"
                           ,nonceCreated, expiredTime, now
                           );
          }
@@ -179,43 +216,39 @@ UtlBoolean SipNonceDb::isNonceValid(const UtlString& nonce,
 
 /* ============================ FUNCTIONS ================================= */
 
-UtlString SipNonceDb::nonceSignature(const UtlString& callId,
-                                     const UtlString& fromTag,
-                                     const UtlString& uri, // :TBD: no longer used
-                                     const UtlString& realm,
-                                     const UtlString& timestamp)
+void SipNonceDb::nonceSignature(const UtlString& callId,
+                                const UtlString& fromTag,
+                                const UtlString& realm,
+                                const char* timestamp,
+                                size_t timestampLength,
+                                char signature[MD5_SIZE + 1]) const
 {
-   UtlString signature;
-   UtlString nonceSigningData(timestamp);
-
    OsSysLog::add(FAC_SIP, PRI_DEBUG,
-                 "nonceSignature: callId='%s' fromTag='%s' realm='%s' timestamp='%s'",
-                 callId.data(), fromTag.data(), realm.data(), timestamp.data()
+                 "nonceSignature: callId='%s' fromTag='%s' realm='%s' timestamp='%.*s'",
+                 callId.data(), fromTag.data(), realm.data(),
+                 (int) timestampLength, timestamp
                  );
-    
-   // create the signature value by hashing the timestamp with
-   //   the callId, fromTag, the realm, and a secret
-   nonceSigningData.append(callId);
-   nonceSigningData.append(fromTag);
-   nonceSigningData.append(mNonceSignatureSecret);
-   nonceSigningData.append(realm);
-
-   NetMd5Codec::encode(nonceSigningData.data(), signature);
 
-   return signature;
+   // create the signature value by signing the timestamp with
+   //   the callId, fromTag and the realm
+   NetMd5Codec inner(mInnerPadHash);
+   inner.hash(timestamp, timestampLength);
+   inner.hash(callId);
+   inner.hash(fromTag);
+   inner.hash(realm);
+   unsigned char innerDigest[MD5_BIN_SIZE];
+   inner.getHashValue(innerDigest);
+
+   NetMd5Codec outer(mOuterPadHash);
+   outer.hash((const char*) innerDigest, sizeof(innerDigest));
+   outer.getEncodedHashValue(signature);
 }
 
-OsBSem*     SharedNonceDb::spLock       = new OsBSem(OsBSem::Q_PRIORITY, OsBSem::FULL);
-SipNonceDb* SharedNonceDb::spSipNonceDb = NULL;
+// The shared instance is created during static initialization, so
+// get() needs no lock
+SipNonceDb* SharedNonceDb::spSipNonceDb = new SipNonceDb();
 
 SipNonceDb* SharedNonceDb::get()
 {
-   // critical region to ensure that only one shared ssl context is created
-   OsLock lock(*spLock);
-
-   if (!spSipNonceDb)
-   {
-      spSipNonceDb = new SipNonceDb();
-   }
    return spSipNonceDb;
 }
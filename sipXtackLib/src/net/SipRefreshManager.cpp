@@ -50,6 +50,10 @@ public:
     int mFailedResponseCode;
     UtlString mFailedResponseText;
     OsTimer* mpRefreshTimer;  // Fires when it is time to resend
+    UtlString mDestination; // host:port of the request URI, key for rate limiting
+    UtlBoolean mInitialRequestSent;
+    UtlBoolean mInFlight; // holds an in-flight slot of the scheduler
+    UtlBoolean mDeferred; // waiting for the scheduler to allow the send
 
 private:
     //! DISALLOWED accendental copying
@@ -73,6 +77,9 @@ RefreshDialogState::RefreshDialogState()
     mRequestState = SipRefreshManager::REFRESH_REQUEST_UNKNOWN;
     mFailedResponseCode = -1;
     mpRefreshTimer = NULL;
+    mInitialRequestSent = FALSE;
+    mInFlight = FALSE;
+    mDeferred = FALSE;
 }
 
 void RefreshDialogState::toString(UtlString& dumpString)
@@ -110,6 +117,12 @@ void RefreshDialogState::toString(UtlString& dumpString)
     dumpString.append("\n\tmpRefreshTimer: ");
     sprintf(numBuf, "%p", mpRefreshTimer);
     dumpString.append(numBuf);
+    dumpString.append("\n\tmDestination: ");
+    dumpString.append(mDestination);
+    dumpString.append("\n\tmInFlight: ");
+    dumpString.append(mInFlight ? "TRUE" : "FALSE");
+    dumpString.append("\n\tmDeferred: ");
+    dumpString.append(mDeferred ? "TRUE" : "FALSE");
 }
 
 // Copy constructor NOT ALLOWED
@@ -141,6 +154,7 @@ SipRefreshManager::SipRefreshManager(SipUserAgent& userAgent,
     mpDialogMgr = &dialogMgr;
     mReceivingRegisterResponses = FALSE;
     mDefaultExpiration = 3600;
+    mDeferredRefreshes = 0;
 }
 
 // Copy constructor
@@ -297,39 +311,68 @@ UtlBoolean SipRefreshManager::initiateRefresh(SipMessage& subscribeOrRegisterReq
         state->mPendingStartTime = now;
         state->mRequestState = REFRESH_REQUEST_PENDING;
 
-        // Set a timer  at which to resend the next refresh based upon the 
-        // assumption that the request will succeed.  When we receive a 
-        // failed response, we will cancel the timer and reschedule
-        // a new timer based upon a smaller fraction of the requested 
-        // expiration period 
-        setRefreshTimer(*state, 
-                        TRUE); // Resend with successful timeout
-        OsTimer* resendTimer = state->mpRefreshTimer;
-
-        OsSysLog::add(FAC_SIP, PRI_DEBUG,
-                      "SipRefreshManager::initiateRefresh refreshTimer just being set.");
-
         // Mark the refresh state as having an outstanding request
         // and make a copy of the request.  The copy needs to be
         // attached to the state before the send incase the response
         // comes back before we return from the send.
-        state->mRequestState = REFRESH_REQUEST_PENDING;
         state->mpLastRequest = new SipMessage(subscribeOrRegisterRequest);
 
         // Add the state to the container of refresh states
         // No need to lock this refreshMgr earlier as this is a new
         // state and no one can touch it until it is in the list.
         lock();
+
+        // The request may have to wait for its slot in the startup
+        // ramp, for a token for its destination or for an in-flight slot
+        OsTime schedulerNow;
+        OsDateTime::getCurTime(schedulerNow);
+        int sendDelay = mScheduler.getStartupDelay(schedulerNow);
+        if(sendDelay == 0)
+        {
+            sendDelay = mScheduler.admit(state->mDestination, schedulerNow);
+        }
+
+        if(sendDelay > 0)
+        {
+            // handleMessage sends the request when the timer fires
+            deferRefresh(*state, sendDelay);
+        }
+        else
+        {
+            state->mInFlight = TRUE;
+            state->mInitialRequestSent = TRUE;
+
+            // Set a timer  at which to resend the next refresh based upon the 
+            // assumption that the request will succeed.  When we receive a 
+            // failed response, we will cancel the timer and reschedule
+            // a new timer based upon a smaller fraction of the requested 
+            // expiration period 
+            setRefreshTimer(*state, 
+                            TRUE); // Resend with successful timeout
+
+            OsSysLog::add(FAC_SIP, PRI_DEBUG,
+                          "SipRefreshManager::initiateRefresh refreshTimer just being set.");
+        }
+        OsTimer* resendTimer = state->mpRefreshTimer;
+
         mRefreshes.insert(state);
         unlock();
         // NOTE: at this point is is no longer safe to touch the state
         // without locking it again.  Avoid locking this refresh mgr
         // when something can block (e.g. like calling SipUserAgent ::send)
 
-        // Send the request
-        // Is the correct?  Should we send the request first and only set
-        // a timer if the request succeeds??
-        intitialRequestSent = mpUserAgent->send(subscribeOrRegisterRequest);
+        if(sendDelay > 0)
+        {
+            // Queued to be sent later
+            intitialRequestSent = TRUE;
+        }
+        else
+        {
+            // Send the request
+            // Is the correct?  Should we send the request first and only set
+            // a timer if the request succeeds??
+            intitialRequestSent = mpUserAgent->send(subscribeOrRegisterRequest);
+        }
 
         // We do not clean up the state even if the send fails.
         // The application must end the refresh as the refresh
@@ -348,6 +391,7 @@ UtlBoolean SipRefreshManager::initiateRefresh(SipMessage& subscribeOrRegisterReq
                 // failed, so we know to resend when the timer
                 // fires
                 state->mRequestState = REFRESH_REQUEST_FAILED;
+                releaseInFlight(*state);
 
                 // The expiration should still be set to zero
 
@@ -391,6 +435,12 @@ UtlBoolean SipRefreshManager::stopRefresh(const char* dialogHandle)
     if(state)
     {
         mRefreshes.removeReference(state);
+        releaseInFlight(*state);
+        if(state->mDeferred)
+        {
+            state->mDeferred = FALSE;
+            mDeferredRefreshes--;
+        }
     }
     unlock();
 
@@ -398,10 +448,12 @@ UtlBoolean SipRefreshManager::stopRefresh(const char* dialogHandle)
     if(state)
     {
         // If the subscription or registration has not expired
-        // or there is a pending request
+        // or there is a pending request.  Nothing to end if the
+        // initial request is still queued.
         long now = OsDateTime::getSecsSinceEpoch();
-        if(state->mExpiration > now || 
-           state->mRequestState == REFRESH_REQUEST_PENDING)
+        if(state->mInitialRequestSent &&
+           (state->mExpiration > now || 
+            state->mRequestState == REFRESH_REQUEST_PENDING))
         {
             if(state->mpLastRequest)
             {
@@ -520,45 +572,76 @@ UtlBoolean SipRefreshManager::handleMessage(OsMsg &eventMessage)
                 deleteTimerAndEvent(state->mpRefreshTimer);
                 state->mpRefreshTimer = NULL;
 
-                // Legitimate states to reSUBSCRIBE or reREGISTER
+                if(state->mDeferred)
+                {
+                    state->mDeferred = FALSE;
+                    mDeferredRefreshes--;
+                }
+
+                // Any prior request has had its final response or
+                // has been given up on by now
+                releaseInFlight(*state);
+
+                // Legitimate states to reSUBSCRIBE or reREGISTER, or
+                // an initial request which was queued by the scheduler
                 if(state->mRequestState == REFRESH_REQUEST_FAILED || 
-                    state->mRequestState == REFRESH_REQUEST_SUCCEEDED)
+                    state->mRequestState == REFRESH_REQUEST_SUCCEEDED ||
+                    !state->mInitialRequestSent)
                 {
-                    // Create and set a new timer for resending assuming
-                    // the resend is successful.  If it fails we will
-                    // cancel the timer and set a shorter timeout
-                    setRefreshTimer(*state, 
-                                    TRUE); // Resend with successful timeout
-
-                    OsSysLog::add(FAC_SIP, PRI_DEBUG,
-                                  "SipRefreshManager::handleMessage refreshTimer just being set for the normal timeout.");
-
-                    // reset the message for resend
-                    setForResend(*state,
-                                 FALSE); // do not expire now
-
-                    // Keep track of when this refresh is sent so we know 
-                    // when the new expiration is relative to.
-                    state->mPendingStartTime = OsDateTime::getSecsSinceEpoch();
-
-                    // Do not want to keep the lock while we send the
-                    // message as it could block.  Presumably it is better
-                    // to incure the cost of copying the message????
-                    SipMessage tempRequest(*(state->mpLastRequest));
+                    OsTime schedulerNow;
+                    OsDateTime::getCurTime(schedulerNow);
+                    int sendDelay = mScheduler.admit(state->mDestination,
+                                                     schedulerNow);
+                    if(sendDelay > 0)
+                    {
+                        // Not allowed to send yet, wait for the scheduler
+                        deferRefresh(*state, sendDelay);
+                    }
+                    else
+                    {
+                        state->mInFlight = TRUE;
+
+                        // Create and set a new timer for resending assuming
+                        // the resend is successful.  If it fails we will
+                        // cancel the timer and set a shorter timeout
+                        setRefreshTimer(*state, 
+                                        TRUE); // Resend with successful timeout
+
+                        OsSysLog::add(FAC_SIP, PRI_DEBUG,
+                                      "SipRefreshManager::handleMessage refreshTimer just being set for the normal timeout.");
+
+                        // reset the message for resend.  A queued initial
+                        // request goes out as it was given to us.
+                        if(state->mInitialRequestSent)
+                        {
+                            setForResend(*state,
+                                         FALSE); // do not expire now
+                        }
+                        state->mInitialRequestSent = TRUE;
+
+                        // Keep track of when this refresh is sent so we know 
+                        // when the new expiration is relative to.
+                        state->mPendingStartTime = OsDateTime::getSecsSinceEpoch();
+
+                        // Do not want to keep the lock while we send the
+                        // message as it could block.  Presumably it is better
+                        // to incure the cost of copying the message????
+                        SipMessage tempRequest(*(state->mpLastRequest));
                     
-                    UtlString lastRequest;
-                    int length;
-                    state->mpLastRequest->getBytes(&lastRequest, &length);
-                    OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipRefreshManager::handleMessage last request = \n%s",
-                                  lastRequest.data());
+                        UtlString lastRequest;
+                        int length;
+                        state->mpLastRequest->getBytes(&lastRequest, &length);
+                        OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipRefreshManager::handleMessage last request = \n%s",
+                                      lastRequest.data());
                       
-                    unlock();
-                    mpUserAgent->send(tempRequest);
-                    // do not need the lock any more, but this gives us
-                    // clean locking symmetry.  DO NOT TOUCH state or
-                    // any of its members BEYOND this point as it may 
-                    // have been deleted
-                    lock(); 
+                        unlock();
+                        mpUserAgent->send(tempRequest);
+                        // do not need the lock any more, but this gives us
+                        // clean locking symmetry.  DO NOT TOUCH state or
+                        // any of its members BEYOND this point as it may 
+                        // have been deleted
+                        lock();
+                    }
                 }
 
                 // This should not happen
@@ -742,6 +825,7 @@ UtlBoolean SipRefreshManager::handleMessage(OsMsg &eventMessage)
 
                     // The request succeeded
                     state->mRequestState = REFRESH_REQUEST_SUCCEEDED;
+                    releaseInFlight(*state);
                 }
 
                 // Provisional response, do nothing
@@ -769,6 +853,7 @@ UtlBoolean SipRefreshManager::handleMessage(OsMsg &eventMessage)
                     state->mFailedResponseCode = responseCode;
                     state->mFailedResponseText = responseText;
                     state->mRequestState = REFRESH_REQUEST_FAILED;
+                    releaseInFlight(*state);
                     // Do not change the expiration date, it
                     // is what ever it was before the response was
                     // sent.
@@ -807,6 +892,43 @@ UtlBoolean SipRefreshManager::handleMessage(OsMsg &eventMessage)
 }
 
 
+void SipRefreshManager::setRateLimit(int requestsPerSecond, int burstSize)
+{
+    lock();
+    mScheduler.setRateLimit(requestsPerSecond, burstSize);
+    unlock();
+}
+
+void SipRefreshManager::setMaxRefreshesInFlight(int maxInFlight)
+{
+    lock();
+    mScheduler.setMaxInFlight(maxInFlight);
+    unlock();
+}
+
+void SipRefreshManager::setRefreshJitter(int percent)
+{
+    lock();
+    mScheduler.setJitter(percent);
+    unlock();
+}
+
+void SipRefreshManager::startBatchRefresh(int requestsPerSecond)
+{
+    OsTime now;
+    OsDateTime::getCurTime(now);
+    lock();
+    mScheduler.startBatch(requestsPerSecond, now);
+    unlock();
+}
+
+void SipRefreshManager::endBatchRefresh()
+{
+    lock();
+    mScheduler.endBatch();
+    unlock();
+}
+
 /* ============================ ACCESSORS ================================= */
 
 void SipRefreshManager::refreshState2String(RefreshRequestState state, 
@@ -860,6 +982,21 @@ int SipRefreshManager::dumpRefreshStates(UtlString& dumpString)
 
 /* ============================ INQUIRY =================================== */
 
+int SipRefreshManager::countDeferredRefreshes() const
+{
+    return(mDeferredRefreshes);
+}
+
+int SipRefreshManager::countRefreshesInFlight() const
+{
+    return(mScheduler.getInFlightCount());
+}
+
+int SipRefreshManager::getThrottledRefreshCount() const
+{
+    return(mScheduler.getThrottledCount());
+}
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
 void SipRefreshManager::lock()
@@ -976,6 +1113,13 @@ RefreshDialogState*
     state->mpRefreshTimer = NULL;  
     state->mpLastRequest = NULL;
 
+    // Requests are rate limited per next hop, approximated by the
+    // host and port of the request URI
+    UtlString requestUri;
+    subscribeOrRegisterRequest.getRequestUri(&requestUri);
+    Url requestUrl(requestUri, TRUE);
+    requestUrl.getHostWithPort(state->mDestination);
+
     return(state);
 }
 
@@ -1010,13 +1154,39 @@ void SipRefreshManager::setRefreshTimer(RefreshDialogState& state,
                   "SipRefreshManager::setRefreshTimer setting resend timeout in %d seconds\n",
                   nextResendSeconds);
 
+    startRefreshTimer(state, nextResendSeconds * 1000);
+}
+
+void SipRefreshManager::startRefreshTimer(RefreshDialogState& state, int msecs)
+{
     OsMsgQ* incomingQ = getMessageQueue();
     OsTimer* resendTimer = new OsTimer(incomingQ,
         (intptr_t)&state);
     state.mpRefreshTimer = resendTimer;
-    OsTime timerTime(nextResendSeconds, 0);
+    OsTime timerTime(msecs / 1000, (msecs % 1000) * 1000);
     resendTimer->oneshotAfter(timerTime);                
+}
 
+void SipRefreshManager::deferRefresh(RefreshDialogState& state, int msecs)
+{
+    // Assume we already have the lock
+    OsSysLog::add(FAC_SIP, PRI_DEBUG,
+                  "SipRefreshManager::deferRefresh request to %s held for %d msecs",
+                  state.mDestination.data(), msecs);
+
+    state.mDeferred = TRUE;
+    mDeferredRefreshes++;
+    startRefreshTimer(state, msecs);
+}
+
+void SipRefreshManager::releaseInFlight(RefreshDialogState& state)
+{
+    // Assume we already have the lock
+    if(state.mInFlight)
+    {
+        state.mInFlight = FALSE;
+        mScheduler.requestDone();
+    }
 }
 
 int SipRefreshManager::calculateResendTime(int requestedExpiration, 
@@ -1032,6 +1202,10 @@ int SipRefreshManager::calculateResendTime(int requestedExpiration,
         expiration = (int)(0.1 * requestedExpiration);
     }
 
+    // Spread refreshes which were scheduled together (e.g. all lines
+    // registered at startup) so they do not keep coming due at once
+    expiration = mScheduler.jitterInterval(expiration * 1000) / 1000;
+
     // Clamp it to a minimum of a transaction timeout
     int minRefresh = (mpUserAgent->getSipStateTransactionTimeout())/1000;
     if(expiration < minRefresh)
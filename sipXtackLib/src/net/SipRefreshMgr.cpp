@@ -878,7 +878,8 @@ SipRefreshMgr::processResponse(
     const OsMsg& eventMessage,
     SipMessage *request)
 {
-    SipMessage* response = (SipMessage*)((SipMessageEvent&)eventMessage).getMessage();
+    // The CSeq may be rewritten below, so do not touch a shared message
+    SipMessage* response = ((SipMessageEvent&)eventMessage).getMessageForWrite();
     SipMessage* requestCopy = mRegisterList.getRequestFor(response);
     if (requestCopy)
     {
@@ -1670,11 +1671,8 @@ SipRefreshMgr::queueMessageToObservers(
             OsMsgQ* observerQueue = observerCriteria->getObserverQueue();
             void* observerData = observerCriteria->getObserverData();
 
-            // Cheat a little and set the observer data to be passed back
-            ((SipMessage*) message)->setResponseListenerData(observerData);
-
-            // Put the message in the observers queue
-            observerQueue->send(event);
+            // Put the message in the observers queue with the observer data
+            event.postToObserver(*observerQueue, observerData);
         }
         //wants requests
         if ( observerCriteria &&
@@ -1684,11 +1682,8 @@ SipRefreshMgr::queueMessageToObservers(
             OsMsgQ* observerQueue = observerCriteria->getObserverQueue();
             void* observerData = observerCriteria->getObserverData();
 
-            // Cheat a little and set the observer data to be passed back
-            ((SipMessage*) message)->setResponseListenerData(observerData);
-
-            // Put the message in the observers queue
-            observerQueue->send(event);
+            // Put the message in the observers queue with the observer data
+            event.postToObserver(*observerQueue, observerData);
         }
 
     }
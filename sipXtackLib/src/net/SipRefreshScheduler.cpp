@@ -0,0 +1,221 @@
+//
+// Copyright (C) 2006-2019 SIPez LLC.  All rights reserved.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+
+// APPLICATION INCLUDES
+#include <utl/UtlString.h>
+#include <net/SipRefreshScheduler.h>
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+
+// Private class holding the token bucket for one destination
+class RefreshTokenBucket : public UtlString
+{
+public:
+
+    RefreshTokenBucket(const UtlString& destination,
+                       int burstSize,
+                       const OsTime& now)
+        : UtlString(destination)
+        , mTokens(burstSize)
+        , mLastRefill(now)
+    {
+    }
+
+    // UtlString::data contains the destination
+    double mTokens;
+    OsTime mLastRefill;
+
+private:
+    //! DISALLOWED accidental copying
+    RefreshTokenBucket(const RefreshTokenBucket& rRefreshTokenBucket);
+    RefreshTokenBucket& operator=(const RefreshTokenBucket& rhs);
+};
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+// Constructor
+SipRefreshScheduler::SipRefreshScheduler()
+    : mRequestsPerSecond(0)
+    , mBurstSize(1)
+    , mMaxInFlight(0)
+    , mJitterPercent(DEFAULT_JITTER_PERCENT)
+    , mBatchRequestsPerSecond(0)
+    , mInFlight(0)
+    , mThrottled(0)
+{
+}
+
+// Destructor
+SipRefreshScheduler::~SipRefreshScheduler()
+{
+    mBuckets.destroyAll();
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+void SipRefreshScheduler::setRateLimit(int requestsPerSecond, int burstSize)
+{
+    mRequestsPerSecond = requestsPerSecond > 0 ? requestsPerSecond : 0;
+    mBurstSize = burstSize > 0 ? burstSize : 1;
+
+    // Buckets are created full at the new burst size as they are needed
+    mBuckets.destroyAll();
+}
+
+void SipRefreshScheduler::setMaxInFlight(int maxInFlight)
+{
+    mMaxInFlight = maxInFlight > 0 ? maxInFlight : 0;
+}
+
+void SipRefreshScheduler::setJitter(int percent)
+{
+    if(percent < 0)
+    {
+        percent = 0;
+    }
+    else if(percent > 100)
+    {
+        percent = 100;
+    }
+    mJitterPercent = percent;
+}
+
+void SipRefreshScheduler::startBatch(int requestsPerSecond, const OsTime& now)
+{
+    mBatchRequestsPerSecond = requestsPerSecond > 0 ? requestsPerSecond : 0;
+    mNextBatchSlot = now;
+}
+
+void SipRefreshScheduler::endBatch()
+{
+    mBatchRequestsPerSecond = 0;
+}
+
+int SipRefreshScheduler::jitterInterval(int intervalMsecs)
+{
+    int spread = (int)((double)intervalMsecs * mJitterPercent / 100);
+    if(spread > 0)
+    {
+        intervalMsecs -= mRandom.rand() % (spread + 1);
+    }
+
+    return(intervalMsecs);
+}
+
+int SipRefreshScheduler::getStartupDelay(const OsTime& now)
+{
+    int delayMsecs = 0;
+
+    if(mBatchRequestsPerSecond > 0)
+    {
+        OsTime slot(now);
+        if(mNextBatchSlot > slot)
+        {
+            slot = mNextBatchSlot;
+            OsTime delay(slot);
+            delay -= now;
+            delayMsecs = delay.cvtToMsecs();
+        }
+
+        // Space the initial requests evenly at the batch rate
+        OsTime spacing(0, 1000000 / mBatchRequestsPerSecond);
+        mNextBatchSlot = slot;
+        mNextBatchSlot += spacing;
+    }
+
+    return(delayMsecs);
+}
+
+int SipRefreshScheduler::admit(const UtlString& destination, const OsTime& now)
+{
+    // Too many requests waiting for a final response, try again shortly.
+    // The wait is spread so that the waiting requests do not all retry
+    // at the same moment.
+    if(mMaxInFlight > 0 && mInFlight >= mMaxInFlight)
+    {
+        mThrottled++;
+        return(IN_FLIGHT_RETRY_MSECS +
+               mRandom.rand() % (IN_FLIGHT_RETRY_MSECS / 2 + 1));
+    }
+
+    if(mRequestsPerSecond > 0)
+    {
+        RefreshTokenBucket* bucket =
+            (RefreshTokenBucket*) mBuckets.find(&destination);
+        if(bucket == NULL)
+        {
+            bucket = new RefreshTokenBucket(destination, mBurstSize, now);
+            mBuckets.insert(bucket);
+        }
+
+        // Refill for the time elapsed since the last request
+        OsTime elapsed(now);
+        elapsed -= bucket->mLastRefill;
+        long elapsedMsecs = elapsed.cvtToMsecs();
+        if(elapsedMsecs > 0)
+        {
+            bucket->mTokens += (double)elapsedMsecs * mRequestsPerSecond / 1000;
+            if(bucket->mTokens > mBurstSize)
+            {
+                bucket->mTokens = mBurstSize;
+            }
+            bucket->mLastRefill = now;
+        }
+
+        if(bucket->mTokens < 1.0)
+        {
+            mThrottled++;
+            int waitMsecs =
+                (int)((1.0 - bucket->mTokens) * 1000 / mRequestsPerSecond) + 1;
+            return(waitMsecs);
+        }
+
+        bucket->mTokens -= 1.0;
+    }
+
+    mInFlight++;
+    return(0);
+}
+
+void SipRefreshScheduler::requestDone()
+{
+    if(mInFlight > 0)
+    {
+        mInFlight--;
+    }
+}
+
+/* ============================ ACCESSORS ================================= */
+
+int SipRefreshScheduler::getInFlightCount() const
+{
+    return(mInFlight);
+}
+
+int SipRefreshScheduler::getThrottledCount() const
+{
+    return(mThrottled);
+}
+
+/* ============================ INQUIRY =================================== */
+
+UtlBoolean SipRefreshScheduler::isBatchActive() const
+{
+    return(mBatchRequestsPerSecond > 0);
+}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
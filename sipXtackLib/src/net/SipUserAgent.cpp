@@ -29,6 +29,7 @@
 #endif
 
 #include <utl/UtlHashBagIterator.h>
+#include <utl/UtlSListIterator.h>
 #include <net/SipSrvLookup.h>
 #include <net/SipUserAgent.h>
 #include <net/SipSession.h>
@@ -43,6 +44,7 @@
 #include <net/SipTcpServer.h>
 #include <net/SipUdpServer.h>
 #include <net/SipLineMgr.h>
+#include <net/SipNonceDb.h>
 #include <tapi/sipXtapiEvents.h>
 #include <os/OsDateTime.h>
 #include <os/OsEvent.h>
@@ -73,6 +75,8 @@
 
 #define MAXIMUM_SIP_LOG_SIZE 100000
 #define SIP_UA_LOG "sipuseragent.log"
+// Seconds for which a nonce issued in an authentication challenge is valid
+#define SIP_UA_NONCE_EXPIRATION 300
 #define CONFIG_LOG_DIR SIPX_LOGDIR
 
 #ifndef  VENDOR
@@ -510,6 +514,7 @@ SipUserAgent::~SipUserAgent()
     }
 
     allowedSipMethods.destroyAll();
+    mObserverIndex.destroyAll();
     mMessageObservers.destroyAll();
     allowedSipExtensions.destroyAll();
 
@@ -629,6 +634,7 @@ void SipUserAgent::addMessageObserver(OsMsgQ& messageQueue,
             // Add the observer and its filter criteria to the list lock scope
         OsWriteLock lock(mObserverMutex);
         mMessageObservers.insert(observer);
+        indexMessageObserver(observer);
 
         // Allow the specified method
         if(sipMethod && *sipMethod && wantRequests)
@@ -657,6 +663,7 @@ UtlBoolean SipUserAgent::removeMessageObserver(OsMsgQ& messageQueue, void* pObse
                     (pObserverData == pObserver->getObserverData()))
             {
                 bRemovedObservers = true ;
+                unindexMessageObserver(pObserver);
                 UtlContainable* wasRemoved = mMessageObservers.removeReference(pObserver);
 
                 if(wasRemoved)
@@ -671,6 +678,55 @@ UtlBoolean SipUserAgent::removeMessageObserver(OsMsgQ& messageQueue, void* pObse
     return bRemovedObservers ;
 }
 
+void SipUserAgent::indexMessageObserver(SipObserverCriteria* observer)
+{
+    // Caller must hold mObserverMutex for writing
+    UtlString eventName;
+    observer->getEventName(eventName);
+    UtlString indexKey;
+    getObserverIndexKey(*observer, eventName, indexKey);
+
+    UtlSList* observerList = (UtlSList*) mObserverIndex.findValue(&indexKey);
+    if (observerList == NULL)
+    {
+        observerList = new UtlSList();
+        mObserverIndex.insertKeyAndValue(new UtlString(indexKey), observerList);
+    }
+    observerList->append(observer);
+}
+
+void SipUserAgent::unindexMessageObserver(SipObserverCriteria* observer)
+{
+    // Caller must hold mObserverMutex for writing
+    UtlString eventName;
+    observer->getEventName(eventName);
+    UtlString indexKey;
+    getObserverIndexKey(*observer, eventName, indexKey);
+
+    UtlSList* observerList = (UtlSList*) mObserverIndex.findValue(&indexKey);
+    if (observerList)
+    {
+        observerList->removeReference(observer);
+        if (observerList->isEmpty())
+        {
+            mObserverIndex.destroy(&indexKey);
+        }
+    }
+}
+
+void SipUserAgent::getObserverIndexKey(const UtlString& method,
+                                       const UtlString& eventName,
+                                       UtlString& indexKey)
+{
+    // Event names match case insensitively
+    UtlString lowerEventName(eventName);
+    lowerEventName.toLower();
+
+    indexKey = method;
+    indexKey.append('\n');
+    indexKey.append(lowerEventName);
+}
+
 void SipUserAgent::allowMethod(const char* methodName, const bool bAllow)
 {
     if(methodName)
@@ -2022,11 +2078,23 @@ void SipUserAgent::dispatch(SipMessage* message, int messageType, SIPX_TRANSPORT
 #ifdef TEST_PRINT
                   osPrintf("SipUserAgent::dispatch message Unauthorized\n");
 #endif
+                  // Issue a nonce signed with the call parameters
+                  UtlString fromTag;
+                  Url fromUrl;
+                  message->getFromUrl(fromUrl);
+                  fromUrl.getFieldParameter("tag", fromTag);
+                  UtlString nonce;
+                  SharedNonceDb::get()->createNewNonce(callIdField,
+                                                       fromTag,
+                                                       "", // uri is not used
+                                                       mAuthenticationRealm,
+                                                       nonce);
+
                   response = new SipMessage();
                   response->setRequestUnauthorized(message,
                                                    mAuthenticationScheme.data(),
                                                    mAuthenticationRealm.data(),
-                                                   "1234567890", // :TODO: nonce should be generated by SipNonceDb
+                                                   nonce.data(),
                                                    "abcdefghij"  // opaque
                                                    );
                }
@@ -2307,6 +2375,12 @@ void SipUserAgent::queueMessageToObservers(SipMessage* message,
    SipMessageEvent event(message);
    event.setMessageStatus(messageType);
 
+   // Observers share the message read only; serialize it now so that
+   // their getBytes() calls only read the cached bytes
+   UtlString messageBytes;
+   int messageLength;
+   message->getBytes(&messageBytes, &messageLength);
+
    // Find all of the observers which are interested in
    // this method and post the message
    UtlBoolean isRsp = message->isResponse();
@@ -2330,97 +2404,68 @@ void SipUserAgent::queueMessageToInterestedObservers(SipMessageEvent& event,
    const SipMessage* message;
    if((message = event.getMessage()))
    {
-      // Find all of the observers which are interested in
-      // this method and post the message
-      UtlString messageEventName;
-      message->getEventField(&messageEventName, NULL, NULL);
-
       // do these constructors before taking the lock
       UtlString observerMatchingMethod(method);
+      UtlString indexKey;
 
       // lock the message observer list
       OsReadLock lock(mObserverMutex);
 
-      UtlHashBagIterator observerIterator(mMessageObservers, &observerMatchingMethod);
       SipObserverCriteria* observerCriteria;
-      while ((observerCriteria = (SipObserverCriteria*) observerIterator()))
+      if (message->isResponse())
       {
-         // Check message direction and type
-         if (   (  message->isResponse() && observerCriteria->wantsResponses())
-             || (! message->isResponse() && observerCriteria->wantsRequests())
-             )
+         // The event filter applies only to requests, so all observers
+         // of this method are interested in the response
+         UtlHashBagIterator observerIterator(mMessageObservers, &observerMatchingMethod);
+         while ((observerCriteria = (SipObserverCriteria*) observerIterator()))
          {
-            // Decide if the event filter applies
-            bool useEventFilter = false;
-            bool matchedEvent = false;
-            if (! message->isResponse()) // events apply only to requests
+            if (observerCriteria->wantsResponses())
             {
-               UtlString criteriaEventName;
-               observerCriteria->getEventName(criteriaEventName);
-
-               useEventFilter = ! criteriaEventName.isNull();
-               if (useEventFilter)
+               queueMessageToObserver(event, observerCriteria);
+            }
+         }
+      }
+      else
+      {
+         // Observers without an event filter
+         getObserverIndexKey(method, "", indexKey);
+         UtlSList* observerList = (UtlSList*) mObserverIndex.findValue(&indexKey);
+         if (observerList)
+         {
+            UtlSListIterator observerIterator(*observerList);
+            while ((observerCriteria = (SipObserverCriteria*) observerIterator()))
+            {
+               if (observerCriteria->wantsRequests())
                {
-                  // see if the event type matches
-                  matchedEvent = (   (   method.compareTo(SIP_SUBSCRIBE_METHOD,
-                                                          UtlString::ignoreCase)
-                                      == 0
-                                      || method.compareTo(SIP_NOTIFY_METHOD,
-                                                          UtlString::ignoreCase)
-                                      == 0
-                                      )
-                                  && 0==messageEventName.compareTo(criteriaEventName,
-                                                                   UtlString::ignoreCase
-                                                                   )
-                                  );
+                  queueMessageToObserver(event, observerCriteria);
                }
-            } // else - this is a response - event filter is not applicable
-
-            // Check to see if the session criteria matters
-            SipSession* pCriteriaSession = observerCriteria->getSession() ;
-            bool useSessionFilter = (NULL != pCriteriaSession);
-            UtlBoolean matchedSession = FALSE;
-            if (useSessionFilter)
-            {
-               // it matters; see if it matches
-               matchedSession = pCriteriaSession->isSameSession((SipMessage&) *message);
             }
+         }
 
-            // We have a message type (req|rsp) the observer wants - apply filters
-            if (   (! useSessionFilter || matchedSession)
-                && (! useEventFilter   || matchedEvent)
-                )
+         // Observers filtering on the event type of a SUBSCRIBE or NOTIFY
+         UtlString messageEventName;
+         message->getEventField(&messageEventName, NULL, NULL);
+         if (   ! messageEventName.isNull()
+             && (   method.compareTo(SIP_SUBSCRIBE_METHOD, UtlString::ignoreCase) == 0
+                 || method.compareTo(SIP_NOTIFY_METHOD, UtlString::ignoreCase) == 0
+                 )
+             )
+         {
+            getObserverIndexKey(method, messageEventName, indexKey);
+            observerList = (UtlSList*) mObserverIndex.findValue(&indexKey);
+            if (observerList)
             {
-               // This event is interesting, so send it up...
-               OsMsgQ* observerQueue = observerCriteria->getObserverQueue();
-               void* observerData = observerCriteria->getObserverData();
-
-               // Cheat a little and set the observer data to be passed back
-               ((SipMessage*) message)->setResponseListenerData(observerData);
-
-               // Put the message in the observers queue
-               if (!mbShuttingDown)
+               UtlSListIterator observerIterator(*observerList);
+               while ((observerCriteria = (SipObserverCriteria*) observerIterator()))
                {
-                  int numMsgs = observerQueue->numMsgs();
-                  int maxMsgs = observerQueue->maxMsgs();
-                  if (numMsgs < maxMsgs)
+                  if (observerCriteria->wantsRequests())
                   {
-                     observerQueue->send(event);
-                  }
-                  else
-                  {
-                     OsSysLog::add(FAC_SIP, PRI_ERR,
-                           "queueMessageToInterestedObservers - queue full (name=%s, numMsgs=%d)",
-                           observerQueue->getName().data(), numMsgs);
+                     queueMessageToObserver(event, observerCriteria);
                   }
                }
             }
          }
-         else
-         {
-            // either direction or req/rsp not a match
-         }
-      } // while observers
+      }
    }
    else
    {
@@ -2428,6 +2473,42 @@ void SipUserAgent::queueMessageToInterestedObservers(SipMessageEvent& event,
    }
 }
 
+void SipUserAgent::queueMessageToObserver(SipMessageEvent& event,
+                                          SipObserverCriteria* observerCriteria)
+{
+   const SipMessage* message = event.getMessage();
+
+   // Check to see if the session criteria matters
+   SipSession* pCriteriaSession = observerCriteria->getSession() ;
+   if (   pCriteriaSession
+       && ! pCriteriaSession->isSameSession((SipMessage&) *message))
+   {
+      return;
+   }
+
+   // This event is interesting, so send it up...
+   OsMsgQ* observerQueue = observerCriteria->getObserverQueue();
+   void* observerData = observerCriteria->getObserverData();
+
+   // Put the message in the observers queue
+   if (!mbShuttingDown)
+   {
+      int numMsgs = observerQueue->numMsgs();
+      int maxMsgs = observerQueue->maxMsgs();
+      if (numMsgs < maxMsgs)
+      {
+         // Queued copies share the message unless the observer data differs
+         event.postToObserver(*observerQueue, observerData);
+      }
+      else
+      {
+         OsSysLog::add(FAC_SIP, PRI_ERR,
+               "queueMessageToInterestedObservers - queue full (name=%s, numMsgs=%d)",
+               observerQueue->getName().data(), numMsgs);
+      }
+   }
+}
+
 
 UtlBoolean checkMethods(SipMessage* message)
 {
@@ -3651,6 +3732,12 @@ void SipUserAgent::printStatus()
     mSipTransactions.toString(txString);
 
     osPrintf("Transactions:\n%s\n", txString.data());
+
+    unsigned long serializeCount;
+    unsigned long cacheHitCount;
+    HttpMessage::getSerializationCounts(serializeCount, cacheHitCount);
+    osPrintf("Message serializations: %lu cached getBytes: %lu\n",
+             serializeCount, cacheHitCount);
 }
 
 void SipUserAgent::startMessageLog(int newMaximumLogSize)
@@ -3987,11 +4074,6 @@ UtlBoolean SipUserAgent::shouldAuthenticate(SipMessage* message) const
 UtlBoolean SipUserAgent::authorized(SipMessage* request, const char* uri) const
 {
     UtlBoolean allowed = FALSE;
-    // Need to create a nonce database for nonce's created
-    // for each message (or find the message for the previous
-    // sequence number containing the authentication response
-    // and nonce for this request)
-    const char* nonce = "1234567890"; // :TBD: should be using nonce from the message
 
     if(mAuthenticationScheme.compareTo("") == 0)
     {
@@ -4008,6 +4090,25 @@ UtlBoolean SipUserAgent::authorized(SipMessage* request, const char* uri) const
         // Look up the password
         mpAuthenticationDb->get(user.data(), password);
 
+        // The nonce in the credentials must be one we issued for this call
+        // and not be stale.  It is self validating, so no record of the
+        // challenges sent is needed.
+        UtlString nonce;
+        UtlString callId;
+        UtlString fromTag;
+        Url fromUrl;
+        request->getDigestAuthorizationData(NULL, NULL, &nonce, NULL, NULL, NULL,
+                                            HttpMessage::SERVER);
+        request->getCallIdField(&callId);
+        request->getFromUrl(fromUrl);
+        fromUrl.getFieldParameter("tag", fromTag);
+        UtlBoolean nonceValid =
+           !nonce.isNull()
+           && SharedNonceDb::get()->isNonceValid(nonce, callId, fromTag,
+                                                 "", // uri is not used
+                                                 mAuthenticationRealm,
+                                                 SIP_UA_NONCE_EXPIRATION);
+
 #ifdef TEST_PRINT
         osPrintf("SipUserAgent::authorized user:%s password found:\"%s\"\n",
             user.data(), password.data());
@@ -4029,9 +4130,10 @@ UtlBoolean SipUserAgent::authorized(SipMessage* request, const char* uri) const
 #ifdef TEST_PRINT
                 osPrintf("SipUserAgent::authorized basic auth. failed\n");
 #endif
-                allowed = request->verifyMd5Authorization(user.data(),
+                allowed = nonceValid
+                   && request->verifyMd5Authorization(user.data(),
                                                 password.data(),
-                                                nonce,
+                                                nonce.data(),
                                                 mAuthenticationRealm.data(),
                                                 uri);
             }
@@ -4049,9 +4151,10 @@ UtlBoolean SipUserAgent::authorized(SipMessage* request, const char* uri) const
                                                 ) == 0
                 )
         {
-            allowed = request->verifyMd5Authorization(user.data(),
+            allowed = nonceValid
+               && request->verifyMd5Authorization(user.data(),
                                                 password.data(),
-                                                nonce,
+                                                nonce.data(),
                                                 mAuthenticationRealm.data(),
                                                 uri);
         }
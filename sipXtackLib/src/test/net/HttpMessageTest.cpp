@@ -34,6 +34,7 @@ class HttpMessageTest : public SIPX_UNIT_BASE_CLASS
     CPPUNIT_TEST(testMd5Digest);
     CPPUNIT_TEST(testEscape);
     CPPUNIT_TEST(testNoHeaders);
+    CPPUNIT_TEST(testBytesCache);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -655,6 +656,20 @@ public:
 
         CPPUNIT_ASSERT_EQUAL_MESSAGE("httpmessage digest test",
             0, responseToken.compareTo(response));
+
+        // RFC 2617 section 3.5 example, with qop=auth
+        UtlString userPasswordDigest;
+        HttpMessage::buildMd5UserPasswordDigest("Mufasa", "testrealm@host.com",
+                                                "Circle Of Life",
+                                                userPasswordDigest);
+        responseToken.remove(0);
+        HttpMessage::buildMd5Digest(userPasswordDigest.data(), NULL,
+                                    "dcd98b7102dd2f0e8b11d0f600bfb0c093",
+                                    "0a4f113b", 1, HTTP_QOP_AUTH,
+                                    "GET", "/dir/index.html", NULL,
+                                    &responseToken);
+        ASSERT_STR_EQUAL("6629fae49393a05397450978507c4ef1",
+                         responseToken.data());
     }
 
   void testEscape()
@@ -688,6 +703,53 @@ public:
     CPPUNIT_ASSERT_MESSAGE("message should be 4 bytes", messageLength == 4);
   }
 
+  void testBytesCache()
+  {
+    HttpMessage message;
+    message.setFirstHeaderLine("GET /index.html HTTP/1.0");
+    message.addHeaderField("Content-Type", "text/plain");
+
+    unsigned long serializeBefore;
+    unsigned long hitBefore;
+    unsigned long serializeAfter;
+    unsigned long hitAfter;
+    UtlString bytes1;
+    UtlString bytes2;
+    int length1;
+    int length2;
+
+    HttpMessage::getSerializationCounts(serializeBefore, hitBefore);
+    message.getBytes(&bytes1, &length1);
+    message.getBytes(&bytes2, &length2);
+    HttpMessage::getSerializationCounts(serializeAfter, hitAfter);
+
+    ASSERT_STR_EQUAL(bytes1.data(), bytes2.data());
+    CPPUNIT_ASSERT_EQUAL(length1, length2);
+    CPPUNIT_ASSERT(serializeAfter - serializeBefore >= 1);
+    CPPUNIT_ASSERT(hitAfter - hitBefore >= 1);
+
+    // Any setter must invalidate the cached bytes
+    unsigned int version = message.getMessageVersion();
+    message.setHeaderValue("Content-Type", "text/html");
+    CPPUNIT_ASSERT(version != message.getMessageVersion());
+    message.getBytes(&bytes2, &length2);
+    CPPUNIT_ASSERT(bytes2.index("text/html") != UTL_NOT_FOUND);
+
+    const char* body = "hello";
+    message.setBody(new HttpBody(body, strlen(body)));
+    message.getBytes(&bytes2, &length2);
+    CPPUNIT_ASSERT(bytes2.index("\r\n\r\nhello") != UTL_NOT_FOUND);
+
+    // A copy shares the cached bytes of its source
+    HttpMessage copy(message);
+    copy.getBytes(&bytes1, &length1);
+    ASSERT_STR_EQUAL(bytes2.data(), bytes1.data());
+
+    copy.setFirstHeaderLine("GET /other.html HTTP/1.0");
+    copy.getBytes(&bytes1, &length1);
+    CPPUNIT_ASSERT(bytes1.index("/other.html") != UTL_NOT_FOUND);
+  }
+
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(HttpMessageTest);
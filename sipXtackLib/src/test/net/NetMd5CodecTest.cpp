@@ -23,6 +23,7 @@ class NetMd5CodecTest : public SIPX_UNIT_BASE_CLASS
 {
     CPPUNIT_TEST_SUITE(NetMd5CodecTest);
     CPPUNIT_TEST(testManipulators);
+    CPPUNIT_TEST(testIncrementalHash);
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -45,6 +46,36 @@ public:
         CPPUNIT_ASSERT_EQUAL_MESSAGE("md5 encode test 2", 
             0, a2EncodedString.compareTo(a2Encoded));
     }
+
+    void testIncrementalHash()
+    {
+        const char* a1Encoded = "806d252e3788478d0cebb3c079f515bc";
+
+        // Hashing in pieces gives the same value as hashing the whole
+        NetMd5Codec md5;
+        md5.hash("john.salesman:", 14);
+        md5.hash(UtlString("sales@www/example.com"));
+        NetMd5Codec copy(md5);
+        md5.hash(":5+5=10", 7);
+
+        UtlString encoded;
+        md5.appendHashValue(encoded);
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("md5 incremental hash",
+            0, encoded.compareTo(a1Encoded));
+
+        // A copy continues from the state it was copied from
+        char encodedText[MD5_SIZE + 1];
+        copy.hash(":5+5=10", 7);
+        copy.getEncodedHashValue(encodedText);
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("md5 copied hash",
+            0, strcmp(encodedText, a1Encoded));
+
+        // Getting the value resets the input
+        md5.hash("", 0);
+        md5.getEncodedHashValue(encodedText);
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("md5 empty hash",
+            0, strcmp(encodedText, "d41d8cd98f00b204e9800998ecf8427e"));
+    }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(NetMd5CodecTest);
@@ -0,0 +1,130 @@
+//
+// Copyright (C) 2004-2006 SIPfoundry Inc.
+// Licensed by SIPfoundry under the LGPL license.
+//
+// Copyright (C) 2004-2006 Pingtel Corp.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <stdio.h>
+
+// APPLICATION INCLUDES
+#include "os/OsDateTime.h"
+#include "net/SipMessage.h"
+#include "net/SipNonceDb.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+int externalForSideEffects;
+
+// CONSTANTS
+#define NUM_REGISTERS 100000
+#define NONCE_EXPIRATION 300
+
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+
+// Report the rate of one phase of the benchmark
+void printRate(const char* phase, OsTime start, OsTime end)
+{
+   double seconds = (end - start).getDouble();
+
+   printf("  %-28s %8.0f per second\n", phase,
+            seconds > 0 ? NUM_REGISTERS / seconds : 0.0);
+}
+
+// Measures the registrar side of Digest authentication of REGISTER
+// requests: issuing a challenge nonce, and checking the nonce and the
+// response of the authenticated retry.
+int main()
+{
+   UtlString realm("example.com");
+   UtlString callId("8c1b0e4c2a7f@10.1.1.2");
+   UtlString fromTag("5e3a2c7b");
+   UtlString uri("sip:example.com");
+   UtlString nonce;
+   int n;
+
+   SipNonceDb* nonceDb = SharedNonceDb::get();
+
+   // Build the authenticated REGISTER once; the benchmark is of the
+   // authentication checks, not of message parsing
+   UtlString userPasswordDigest;
+   HttpMessage::buildMd5UserPasswordDigest("alice", realm.data(), "secret",
+                                           userPasswordDigest);
+   nonceDb->createNewNonce(callId, fromTag, uri, realm, nonce);
+   UtlString response;
+   HttpMessage::buildMd5Digest(userPasswordDigest.data(), NULL, nonce.data(),
+                               NULL, 0, NULL, SIP_REGISTER_METHOD, uri.data(),
+                               NULL, &response);
+
+   UtlString registerText(
+      "REGISTER sip:example.com SIP/2.0\r\n"
+      "Via: SIP/2.0/UDP 10.1.1.2:5060;branch=z9hG4bK-2f8a1c\r\n"
+      "To: <sip:alice@example.com>\r\n"
+      "From: <sip:alice@example.com>;tag=5e3a2c7b\r\n"
+      "Call-Id: 8c1b0e4c2a7f@10.1.1.2\r\n"
+      "Cseq: 2 REGISTER\r\n"
+      "Contact: <sip:alice@10.1.1.2:5060>\r\n"
+      "Expires: 3600\r\n"
+      "Authorization: Digest username=\"alice\", realm=\"example.com\", nonce=\"");
+   registerText.append(nonce);
+   registerText.append("\", uri=\"sip:example.com\", response=\"");
+   registerText.append(response);
+   registerText.append("\"\r\nContent-Length: 0\r\n\r\n");
+   SipMessage registerRequest(registerText.data(), registerText.length());
+
+   OsTime nonceStart;
+   OsTime nonceDone;
+   OsTime validateDone;
+   OsTime verifyDone;
+
+   OsDateTime::getCurTime(nonceStart);
+   for (n = 0; n < NUM_REGISTERS; n++)
+   {
+      UtlString challengeNonce;
+      nonceDb->createNewNonce(callId, fromTag, uri, realm, challengeNonce);
+      externalForSideEffects += challengeNonce.length();
+   }
+   OsDateTime::getCurTime(nonceDone);
+
+   for (n = 0; n < NUM_REGISTERS; n++)
+   {
+      externalForSideEffects +=
+         nonceDb->isNonceValid(nonce, callId, fromTag, uri, realm, NONCE_EXPIRATION);
+   }
+   OsDateTime::getCurTime(validateDone);
+
+   for (n = 0; n < NUM_REGISTERS; n++)
+   {
+      externalForSideEffects +=
+         registerRequest.verifyMd5Authorization("alice",
+                                                userPasswordDigest.data(),
+                                                nonce.data(),
+                                                realm.data(),
+                                                uri.data());
+   }
+   OsDateTime::getCurTime(verifyDone);
+
+   if (externalForSideEffects != 2 * NUM_REGISTERS
+       + NUM_REGISTERS * (int) nonce.length())
+   {
+      printf("Authentication failed\n");
+      return 1;
+   }
+
+   printf("SIP Digest Performance, %d authenticated REGISTERs:\n",
+            NUM_REGISTERS);
+   printRate("challenge nonces", nonceStart, nonceDone);
+   printRate("nonce validations", nonceDone, validateDone);
+   printRate("digest verifications", validateDone, verifyDone);
+   printRate("authenticated REGISTERs", nonceStart, verifyDone);
+
+   return 0;
+}
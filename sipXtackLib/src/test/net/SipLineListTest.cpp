@@ -0,0 +1,182 @@
+//
+// Copyright (C) 2004-2006 SIPfoundry Inc.
+// Licensed by SIPfoundry under the LGPL license.
+//
+// Copyright (C) 2004-2006 Pingtel Corp.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sipxunittests.h>
+
+#include <os/OsDefs.h>
+#include <net/SipLineList.h>
+#include <net/HttpMessage.h>
+
+/**
+ * Unittest for SipLineList
+ */
+class SipLineListTest : public SIPX_UNIT_BASE_CLASS
+{
+    CPPUNIT_TEST_SUITE(SipLineListTest);
+    CPPUNIT_TEST(testGetLine);
+    CPPUNIT_TEST(testFindLine);
+    CPPUNIT_TEST(testRemoveAndUpdate);
+    CPPUNIT_TEST(testCredentials);
+    CPPUNIT_TEST_SUITE_END();
+
+    SipLine* newLine(const char* identity, const char* user)
+    {
+        Url url(identity);
+        return new SipLine(url, url, user);
+    }
+
+public:
+    void testGetLine()
+    {
+        SipLineList lines;
+        SipLine* alice = newLine("sip:alice@example.com", "alice");
+        SipLine* bob = newLine("sip:bob@example.com", "bob");
+        SipLine* bob2 = newLine("sip:bob@example.net:5070", "bob");
+        lines.add(alice);
+        lines.add(bob);
+        lines.add(bob2);
+
+        CPPUNIT_ASSERT_EQUAL(3, lines.getListSize());
+
+        // By identity, host is not case sensitive, port must match
+        CPPUNIT_ASSERT(lines.getLine(Url("sip:alice@EXAMPLE.com")) == alice);
+        CPPUNIT_ASSERT(lines.getLine(Url("<sip:bob@example.net:5070>")) == bob2);
+        CPPUNIT_ASSERT(lines.getLine(Url("sip:bob@example.net")) == NULL);
+        CPPUNIT_ASSERT(lines.getLine(Url("sip:Alice@example.com")) == NULL);
+        CPPUNIT_ASSERT(lines.isDuplicate(Url("sip:bob@example.com")));
+        CPPUNIT_ASSERT(!lines.isDuplicate(Url("sip:carol@example.com")));
+
+        // By line id
+        CPPUNIT_ASSERT(lines.getLine(bob2->getLineId()) == bob2);
+        CPPUNIT_ASSERT(lines.getLine(UtlString("nosuchlineid")) == NULL);
+        CPPUNIT_ASSERT(lines.getLine(UtlString()) == NULL);
+
+        // By user id, first added wins
+        int matches = 0;
+        CPPUNIT_ASSERT(lines.getLine(UtlString("bob"), matches) == bob);
+        CPPUNIT_ASSERT_EQUAL(2, matches);
+        CPPUNIT_ASSERT(lines.getLine(UtlString("alice"), matches) == alice);
+        CPPUNIT_ASSERT_EQUAL(1, matches);
+        CPPUNIT_ASSERT(lines.getLine(UtlString("carol"), matches) == NULL);
+        CPPUNIT_ASSERT_EQUAL(0, matches);
+    }
+
+    void testFindLine()
+    {
+        SipLineList lines;
+        SipLine* alice = newLine("sip:alice@example.com", "alice");
+        SipLine* bob = newLine("sip:bob@example.com", "bob");
+        SipLine* other = newLine("sip:other@example.com", "other");
+        alice->addCredentials("example.com", "alice", "secret", HTTP_DIGEST_AUTHENTICATION);
+        bob->addCredentials("example.com", "bob", "secret", HTTP_DIGEST_AUTHENTICATION);
+        other->addCredentials("example.net", "other", "secret", HTTP_DIGEST_AUTHENTICATION);
+        lines.add(alice);
+        lines.add(bob);
+        lines.add(other);
+
+        Url none("sip:nobody@example.org");
+
+        // Line id beats the from URL
+        CPPUNIT_ASSERT(lines.findLine(bob->getLineId(), "example.com",
+                                      Url("sip:alice@example.com"), "alice",
+                                      none) == bob);
+        // From URL beats the user
+        CPPUNIT_ASSERT(lines.findLine("", "example.com",
+                                      Url("sip:alice@example.com"), "bob",
+                                      none) == alice);
+        // User beats the default line
+        CPPUNIT_ASSERT(lines.findLine("", "example.com", none, "bob",
+                                      Url("sip:alice@example.com")) == bob);
+        // Default line
+        CPPUNIT_ASSERT(lines.findLine("", "example.com", none, "carol",
+                                      Url("sip:alice@example.com")) == alice);
+
+        // Lines without credentials for the realm are skipped
+        CPPUNIT_ASSERT(lines.findLine(other->getLineId(), "example.com",
+                                      Url("sip:other@example.com"), "other",
+                                      none) == NULL);
+        CPPUNIT_ASSERT(lines.findLine(other->getLineId(), "example.net",
+                                      none, NULL, none) == other);
+        CPPUNIT_ASSERT(lines.findLine(bob->getLineId(), "example.net",
+                                      Url("sip:alice@example.com"), "alice",
+                                      none) == NULL);
+        // unless no realm is given
+        CPPUNIT_ASSERT(lines.findLine(other->getLineId(), "",
+                                      none, NULL, none) == other);
+    }
+
+    void testRemoveAndUpdate()
+    {
+        SipLineList lines;
+        SipLine* alice = newLine("sip:alice@example.com", "alice");
+        SipLine* bob = newLine("sip:bob@example.com", "bob");
+        lines.add(alice);
+        lines.add(bob);
+
+        UtlString aliceLineId(alice->getLineId());
+        CPPUNIT_ASSERT(lines.remove(alice));
+        CPPUNIT_ASSERT(!lines.remove(Url("sip:alice@example.com")));
+        CPPUNIT_ASSERT_EQUAL(1, lines.getListSize());
+        CPPUNIT_ASSERT(lines.getLine(Url("sip:alice@example.com")) == NULL);
+        CPPUNIT_ASSERT(lines.getLine(aliceLineId) == NULL);
+        int matches = 0;
+        CPPUNIT_ASSERT(lines.getLine(UtlString("alice"), matches) == NULL);
+        CPPUNIT_ASSERT(lines.findLine(aliceLineId, NULL, Url("sip:alice@example.com"),
+                                      "alice", Url("sip:alice@example.com")) == NULL);
+        delete alice;
+
+        // Modified in place, then reindexed
+        Url carol("sip:carol@example.com");
+        bob->setIdentityAndUrl(carol, carol);
+        bob->setUser("carol");
+        lines.updateIndex();
+        CPPUNIT_ASSERT(lines.getLine(Url("sip:bob@example.com")) == NULL);
+        CPPUNIT_ASSERT(lines.getLine(carol) == bob);
+        CPPUNIT_ASSERT(lines.getLine(bob->getLineId()) == bob);
+        CPPUNIT_ASSERT(lines.getLine(UtlString("carol"), matches) == bob);
+        CPPUNIT_ASSERT(lines.findLine(NULL, NULL, Url("sip:nobody@example.com"),
+                                      "carol", Url("sip:nobody@example.com")) == bob);
+    }
+
+    void testCredentials()
+    {
+        SipLine line(Url("sip:alice@example.com"), Url("sip:alice@example.com"), "alice");
+        line.addCredentials("example.com", "alice", "secret", HTTP_DIGEST_AUTHENTICATION);
+        line.addCredentials("", "anyalice", "anysecret", HTTP_DIGEST_AUTHENTICATION);
+
+        UtlString userId;
+        UtlString digest;
+        UtlString expected;
+
+        CPPUNIT_ASSERT(line.getCredentials(HTTP_DIGEST_AUTHENTICATION, "example.com",
+                                           &userId, &digest));
+        HttpMessage::buildMd5UserPasswordDigest("alice", "example.com", "secret", expected);
+        ASSERT_STR_EQUAL("alice", userId.data());
+        ASSERT_STR_EQUAL(expected.data(), digest.data());
+
+        // The wildcard credentials are hashed with the challenge's realm
+        CPPUNIT_ASSERT(line.getCredentials(HTTP_DIGEST_AUTHENTICATION, "example.org",
+                                           &userId, &digest));
+        expected.remove(0);
+        HttpMessage::buildMd5UserPasswordDigest("anyalice", "example.org", "anysecret", expected);
+        ASSERT_STR_EQUAL("anyalice", userId.data());
+        ASSERT_STR_EQUAL(expected.data(), digest.data());
+
+        // Copies carry the digests
+        SipLine copy(line);
+        CPPUNIT_ASSERT(copy.getCredentials(HTTP_DIGEST_AUTHENTICATION, "example.com",
+                                           &userId, &digest));
+        expected.remove(0);
+        HttpMessage::buildMd5UserPasswordDigest("alice", "example.com", "secret", expected);
+        ASSERT_STR_EQUAL(expected.data(), digest.data());
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SipLineListTest);
@@ -17,6 +17,8 @@
 #include <os/OsDefs.h>
 #include <net/SipMessage.h>
 #include <net/SipUserAgent.h>
+#include <net/SipMessageEvent.h>
+#include <os/OsMsgQ.h>
 
 #if 0
 #include <stdio.h>
@@ -53,6 +55,7 @@ class SipMessageTest : public SIPX_UNIT_BASE_CLASS
       CPPUNIT_TEST(testCompactNames);
       CPPUNIT_TEST(testHeaderFieldAccessors);
       CPPUNIT_TEST(testApplyTargetUriHeaderParams);
+      CPPUNIT_TEST(testMessageEventSharing);
       CPPUNIT_TEST_SUITE_END();
 
       public:
@@ -1781,6 +1784,62 @@ Content-Length: 0\n\
           }
           CPPUNIT_ASSERT( messageBytes.compareTo(expectedMessage) == 0);
       }
+
+   void testMessageEventSharing()
+      {
+         const char* message =
+            "NOTIFY sip:watcher@example.com SIP/2.0\r\n"
+            "Via: SIP/2.0/UDP 10.1.1.1;branch=z9hG4bK-1234\r\n"
+            "To: <sip:watcher@example.com>;tag=2\r\n"
+            "From: <sip:notifier@example.com>;tag=1\r\n"
+            "Call-Id: event-sharing-test\r\n"
+            "Cseq: 1 NOTIFY\r\n"
+            "Event: dialog\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n";
+
+         SipMessageEvent event(new SipMessage(message, strlen(message)));
+         const SipMessage* original = event.getMessage();
+         CPPUNIT_ASSERT(!event.isMessageShared());
+
+         // Copies share the message
+         SipMessageEvent* copy = (SipMessageEvent*) event.createCopy();
+         CPPUNIT_ASSERT(copy->getMessage() == original);
+         CPPUNIT_ASSERT(copy->isMessageShared());
+         CPPUNIT_ASSERT(event.isMessageShared());
+
+         // Writing makes a private copy
+         SipMessage* writable = copy->getMessageForWrite();
+         CPPUNIT_ASSERT(writable != original);
+         CPPUNIT_ASSERT(!copy->isMessageShared());
+         CPPUNIT_ASSERT(!event.isMessageShared());
+         writable->setCSeqField(2, SIP_NOTIFY_METHOD);
+         int cseq;
+         UtlString method;
+         original->getCSeqField(&cseq, &method);
+         CPPUNIT_ASSERT_EQUAL(1, cseq);
+         delete copy;
+
+         // Posting to observers shares the message unless the
+         // observer data differs
+         OsMsgQ observerQueue;
+         int observerData;
+         OsMsg* received;
+         CPPUNIT_ASSERT(event.postToObserver(observerQueue, NULL) == OS_SUCCESS);
+         CPPUNIT_ASSERT(observerQueue.receive(received, OsTime::NO_WAIT_TIME) == OS_SUCCESS);
+         CPPUNIT_ASSERT(((SipMessageEvent*) received)->getMessage() == original);
+         received->releaseMsg();
+
+         CPPUNIT_ASSERT(event.postToObserver(observerQueue, &observerData) == OS_SUCCESS);
+         CPPUNIT_ASSERT(observerQueue.receive(received, OsTime::NO_WAIT_TIME) == OS_SUCCESS);
+         const SipMessage* observed = ((SipMessageEvent*) received)->getMessage();
+         CPPUNIT_ASSERT(observed != original);
+         CPPUNIT_ASSERT(observed->getResponseListenerData() == &observerData);
+         CPPUNIT_ASSERT(original->getResponseListenerData() == NULL);
+         received->releaseMsg();
+
+         CPPUNIT_ASSERT(!event.isMessageShared());
+      }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SipMessageTest);
@@ -0,0 +1,71 @@
+//
+// Copyright (C) 2004-2006 SIPfoundry Inc.
+// Licensed by SIPfoundry under the LGPL license.
+//
+// Copyright (C) 2004-2006 Pingtel Corp.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sipxunittests.h>
+
+#include <os/OsDefs.h>
+#include <net/SipNonceDb.h>
+
+/**
+ * Unittest for SipNonceDb
+ */
+class SipNonceDbTest : public SIPX_UNIT_BASE_CLASS
+{
+    CPPUNIT_TEST_SUITE(SipNonceDbTest);
+    CPPUNIT_TEST(testValidation);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+    void testValidation()
+    {
+        UtlString callId("a84b4c76e66710@pc33.atlanta.com");
+        UtlString fromTag("1928301774");
+        UtlString uri("sip:bob@biloxi.com");
+        UtlString realm("atlanta.com");
+        UtlString nonce;
+
+        SipNonceDb* nonceDb = SharedNonceDb::get();
+        CPPUNIT_ASSERT(nonceDb == SharedNonceDb::get());
+
+        nonceDb->createNewNonce(callId, fromTag, uri, realm, nonce);
+        CPPUNIT_ASSERT(nonce.length() > MD5_SIZE);
+        CPPUNIT_ASSERT(nonceDb->isNonceValid(nonce, callId, fromTag, uri, realm, 300));
+
+        // A nonce is only good for the call and realm it was issued for
+        CPPUNIT_ASSERT(!nonceDb->isNonceValid(nonce, UtlString("other-call"),
+                                              fromTag, uri, realm, 300));
+        CPPUNIT_ASSERT(!nonceDb->isNonceValid(nonce, callId, UtlString("1"),
+                                              uri, realm, 300));
+        CPPUNIT_ASSERT(!nonceDb->isNonceValid(nonce, callId, fromTag,
+                                              uri, UtlString("biloxi.com"), 300));
+
+        // The signature covers the timestamp
+        UtlString forged(nonce);
+        forged.append("0");
+        CPPUNIT_ASSERT(!nonceDb->isNonceValid(forged, callId, fromTag, uri, realm, 300));
+        forged = nonce;
+        forged.replaceAt(0, forged(0) == '0' ? '1' : '0');
+        CPPUNIT_ASSERT(!nonceDb->isNonceValid(forged, callId, fromTag, uri, realm, 300));
+
+        // Too short to hold a signature and a timestamp
+        CPPUNIT_ASSERT(!nonceDb->isNonceValid(UtlString("1234567890"),
+                                              callId, fromTag, uri, realm, 300));
+
+        // Expired
+        CPPUNIT_ASSERT(!nonceDb->isNonceValid(nonce, callId, fromTag, uri, realm, -1));
+
+        // A separate instance issues compatible nonces
+        SipNonceDb otherDb;
+        CPPUNIT_ASSERT(otherDb.isNonceValid(nonce, callId, fromTag, uri, realm, 300));
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SipNonceDbTest);
@@ -0,0 +1,165 @@
+//
+// Copyright (C) 2006-2019 SIPez LLC.  All rights reserved.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sipxunittests.h>
+
+#include <os/OsDefs.h>
+#include <utl/UtlString.h>
+#include <net/SipRefreshScheduler.h>
+
+/**
+ * Unittest for SipRefreshScheduler
+ */
+class SipRefreshSchedulerTest : public SIPX_UNIT_BASE_CLASS
+{
+    CPPUNIT_TEST_SUITE(SipRefreshSchedulerTest);
+    CPPUNIT_TEST(testUnlimited);
+    CPPUNIT_TEST(testRateLimit);
+    CPPUNIT_TEST(testInFlightLimit);
+    CPPUNIT_TEST(testJitter);
+    CPPUNIT_TEST(testStartupBatch);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+    void testUnlimited()
+    {
+        SipRefreshScheduler scheduler;
+        UtlString proxy("proxy.example.com:5060");
+        OsTime now(1000, 0);
+
+        for (int i = 0; i < 1000; i++)
+        {
+            CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, now));
+        }
+        CPPUNIT_ASSERT_EQUAL(1000, scheduler.getInFlightCount());
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.getThrottledCount());
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.getStartupDelay(now));
+
+        scheduler.requestDone();
+        CPPUNIT_ASSERT_EQUAL(999, scheduler.getInFlightCount());
+    }
+
+    void testRateLimit()
+    {
+        SipRefreshScheduler scheduler;
+        UtlString proxy("proxy.example.com:5060");
+        UtlString other("other.example.com:5060");
+        OsTime now(1000, 0);
+
+        // 10 per second with a burst of 3
+        scheduler.setRateLimit(10, 3);
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, now));
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, now));
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, now));
+
+        // The burst is used up, wait for the next token
+        int wait = scheduler.admit(proxy, now);
+        CPPUNIT_ASSERT(wait > 0);
+        CPPUNIT_ASSERT(wait <= 101);
+        CPPUNIT_ASSERT_EQUAL(1, scheduler.getThrottledCount());
+        CPPUNIT_ASSERT_EQUAL(3, scheduler.getInFlightCount());
+
+        // Each destination has its own bucket
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(other, now));
+
+        // One token per 100 msecs
+        OsTime later(1000, 100000);
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, later));
+        CPPUNIT_ASSERT(scheduler.admit(proxy, later) > 0);
+
+        // The bucket never holds more than the burst
+        OsTime muchLater(2000, 0);
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, muchLater));
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, muchLater));
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, muchLater));
+        CPPUNIT_ASSERT(scheduler.admit(proxy, muchLater) > 0);
+
+        // Disabled again
+        scheduler.setRateLimit(0, 0);
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, muchLater));
+    }
+
+    void testInFlightLimit()
+    {
+        SipRefreshScheduler scheduler;
+        UtlString proxy("proxy.example.com:5060");
+        OsTime now(1000, 0);
+
+        scheduler.setMaxInFlight(2);
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, now));
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, now));
+
+        int wait = scheduler.admit(proxy, now);
+        CPPUNIT_ASSERT(wait >= SipRefreshScheduler::IN_FLIGHT_RETRY_MSECS);
+        CPPUNIT_ASSERT(wait <= SipRefreshScheduler::IN_FLIGHT_RETRY_MSECS * 3 / 2);
+        CPPUNIT_ASSERT_EQUAL(2, scheduler.getInFlightCount());
+
+        scheduler.requestDone();
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.admit(proxy, now));
+        CPPUNIT_ASSERT_EQUAL(2, scheduler.getInFlightCount());
+
+        // Releasing more than was admitted does not go negative
+        scheduler.requestDone();
+        scheduler.requestDone();
+        scheduler.requestDone();
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.getInFlightCount());
+    }
+
+    void testJitter()
+    {
+        SipRefreshScheduler scheduler;
+        int interval = 1980000; // 0.55 of an hour, in msecs
+        int minSeen = interval;
+
+        // Refreshes are only ever moved earlier, by at most the jitter
+        for (int i = 0; i < 1000; i++)
+        {
+            int jittered = scheduler.jitterInterval(interval);
+            CPPUNIT_ASSERT(jittered <= interval);
+            CPPUNIT_ASSERT(jittered >= interval * 9 / 10);
+            if (jittered < minSeen)
+            {
+                minSeen = jittered;
+            }
+        }
+        // and they are actually spread
+        CPPUNIT_ASSERT(minSeen < interval * 99 / 100);
+
+        scheduler.setJitter(0);
+        CPPUNIT_ASSERT_EQUAL(interval, scheduler.jitterInterval(interval));
+    }
+
+    void testStartupBatch()
+    {
+        SipRefreshScheduler scheduler;
+        OsTime now(1000, 0);
+
+        CPPUNIT_ASSERT(!scheduler.isBatchActive());
+
+        // 20 per second: one every 50 msecs
+        scheduler.startBatch(20, now);
+        CPPUNIT_ASSERT(scheduler.isBatchActive());
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.getStartupDelay(now));
+        CPPUNIT_ASSERT_EQUAL(50, scheduler.getStartupDelay(now));
+        CPPUNIT_ASSERT_EQUAL(100, scheduler.getStartupDelay(now));
+
+        // Slots are relative to the time of the request
+        OsTime later(1000, 120000);
+        CPPUNIT_ASSERT_EQUAL(30, scheduler.getStartupDelay(later));
+
+        // After a lull the next request goes right away
+        OsTime muchLater(1010, 0);
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.getStartupDelay(muchLater));
+        CPPUNIT_ASSERT_EQUAL(50, scheduler.getStartupDelay(muchLater));
+
+        scheduler.endBatch();
+        CPPUNIT_ASSERT(!scheduler.isBatchActive());
+        CPPUNIT_ASSERT_EQUAL(0, scheduler.getStartupDelay(muchLater));
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SipRefreshSchedulerTest);